@@ -0,0 +1,201 @@
+#include "aac.h"
+#include "bitreader.h"
+#include <string.h>
+
+// @see 1.6.3.3 samplingFrequencyIndex
+static const uint32_t aac_sample_rates[] = {
+    96000, 88200, 64000, 48000, 44100, 32000,
+    24000, 22050, 16000, 12000, 11025, 8000,
+    7350, 0, 0, 0,
+};
+
+// GetAudioObjectType(), 31 escapes to 32 + 6 bits.
+static uint8_t read_object_type(BitReader* br)
+{
+    uint8_t v = (uint8_t)br->ReadBits(5);
+    if (v == 31) {
+        v = (uint8_t)(32 + br->ReadBits(6));
+    }
+    return v;
+}
+
+// the samplingFrequencyIndex, and the frequency which is explicit
+// for the escape index 0xf.
+static uint32_t read_sample_rate(BitReader* br, uint8_t* pindex)
+{
+    uint8_t index = (uint8_t)br->ReadBits(4);
+    *pindex = index;
+    if (index == 0x0f) {
+        return br->ReadBits(24);
+    }
+    return aac_sample_rates[index];
+}
+
+// GASpecificConfig, the program config element is not decoded.
+static void read_ga_specific_config(BitReader* br, AacConfig* c)
+{
+    c->frame_length = br->ReadBit() ? 960 : 1024;
+    // dependsOnCoreCoder, coreCoderDelay
+    if (br->ReadBit()) {
+        br->SkipBits(14);
+    }
+    bool extension_flag = br->ReadBit();
+    if (c->object_type == 6 || c->object_type == 20) {
+        // layerNr
+        br->SkipBits(3);
+    }
+    if (extension_flag) {
+        if (c->object_type == 22) {
+            // numOfSubFrame, layer_length
+            br->SkipBits(5 + 11);
+        }
+        if (c->object_type == 17 || c->object_type == 19 || c->object_type == 20 || c->object_type == 23) {
+            // the resilience flags.
+            br->SkipBits(3);
+        }
+        // extensionFlag3
+        br->SkipBits(1);
+    }
+}
+
+error_t aac_decode_config(const char* data, int size, AacConfig* c)
+{
+    memset(c, 0, sizeof(AacConfig));
+    c->sbr = -1;
+    c->ps = -1;
+    c->frame_length = 1024;
+
+    BitReader br(data, size);
+    c->object_type = read_object_type(&br);
+    c->sample_rate = read_sample_rate(&br, &c->sample_rate_index);
+    c->channels = (uint8_t)br.ReadBits(4);
+
+    // explicit hierarchical signaling, the core follows the extension.
+    if (c->object_type == 5 || c->object_type == 29) {
+        c->extension_object_type = 5;
+        c->sbr = 1;
+        if (c->object_type == 29) {
+            c->ps = 1;
+        }
+        uint8_t index = 0;
+        c->extension_sample_rate = read_sample_rate(&br, &index);
+        c->object_type = read_object_type(&br);
+        if (c->object_type == 22) {
+            // extensionChannelConfiguration
+            br.SkipBits(4);
+        }
+    }
+
+    bool ga = false;
+    switch (c->object_type) {
+    case 1: case 2: case 3: case 4: case 6: case 7:
+    case 17: case 19: case 20: case 21: case 22: case 23:
+        ga = true;
+        read_ga_specific_config(&br, c);
+        break;
+    default:
+        break;
+    }
+    if (br.Overflow()) {
+        return errors_new(-1, "AudioSpecificConfig requires more than %d bytes", size);
+    }
+
+    // the rest is unknown after a program config element or a non GA
+    // object type, so no backward compatible signaling is looked for.
+    if (!ga || c->channels == 0) {
+        return errorsOK;
+    }
+    switch (c->object_type) {
+    case 17: case 19: case 20: case 21: case 22: case 23:
+        // epConfig, the ErrorProtectionSpecificConfig is not expected.
+        if (br.ReadBits(2) >= 2) {
+            return errorsOK;
+        }
+        break;
+    default:
+        break;
+    }
+
+    // backward compatible signaling, the sync extension after the config.
+    if (c->extension_object_type != 5 && br.BitsLeft() >= 16) {
+        if (br.ReadBits(11) == 0x2b7) {
+            uint8_t ext = read_object_type(&br);
+            if (ext == 5) {
+                c->sbr = (int8_t)br.ReadBit();
+                if (c->sbr) {
+                    c->extension_object_type = 5;
+                    uint8_t index = 0;
+                    c->extension_sample_rate = read_sample_rate(&br, &index);
+                    if (br.BitsLeft() >= 12 && br.ReadBits(11) == 0x548) {
+                        c->ps = (int8_t)br.ReadBit();
+                    }
+                }
+            }
+        }
+        if (br.Overflow()) {
+            return errors_new(-1, "sync extension requires more than %d bytes", size);
+        }
+    }
+
+    return errorsOK;
+}
+
+void aac_write_adts_header(const AacConfig* c, int size, char* header)
+{
+    // 7 bytes header without crc, @see 1.A.2.2 of ISO_IEC_14496-3.
+    int frame_length = size + 7;
+    uint8_t profile = (uint8_t)(c->object_type - 1);
+    uint8_t index = c->sample_rate_index;
+    if (index == 0x0f) {
+        // the nearest index of the explicit frequency.
+        index = 0;
+        while (index < 12 && aac_sample_rates[index] > c->sample_rate) {
+            index++;
+        }
+    }
+
+    header[0] = (char)0xff;
+    // MPEG-4, layer 0, protection absent.
+    header[1] = (char)0xf1;
+    header[2] = (char)(((profile & 0x03) << 6) | ((index & 0x0f) << 2) | ((c->channels >> 2) & 0x01));
+    header[3] = (char)(((c->channels & 0x03) << 6) | ((frame_length >> 11) & 0x03));
+    header[4] = (char)((frame_length >> 3) & 0xff);
+    // buffer fullness 0x7ff, a single raw data block.
+    header[5] = (char)(((frame_length & 0x07) << 5) | 0x1f);
+    header[6] = (char)0xfc;
+}
+
+AacConfigCache::AacConfigCache()
+{
+    valid = false;
+    memset(&config, 0, sizeof(AacConfig));
+}
+
+AacConfigCache::~AacConfigCache()
+{
+}
+
+error_t AacConfigCache::Update(const char* data, int size, bool* pchanged)
+{
+    error_t err = errorsOK;
+    *pchanged = false;
+
+    if (valid && bytes.size() == (size_t)size && memcmp(bytes.data(), data, size) == 0) {
+        return err;
+    }
+
+    valid = false;
+    bytes.assign(data, size);
+    if ((err = aac_decode_config(data, size, &config)) != errorsOK) {
+        return errors_wrap(err, "decode aac config");
+    }
+    valid = true;
+    *pchanged = true;
+
+    return err;
+}
+
+const AacConfig* AacConfigCache::Config()
+{
+    return valid ? &config : NULL;
+}
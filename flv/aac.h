@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include "error.h"
+
+/**
+ * the decoded AudioSpecificConfig of an aac stream.
+ * @see 1.6.2.1 AudioSpecificConfig ISO_IEC_14496-3-AAC-2001
+ */
+typedef struct AacConfig {
+    // the audioObjectType, after the escape of 31, e.g. 2 for LC.
+    uint8_t object_type;
+    // the samplingFrequencyIndex, 0xf when the frequency is explicit.
+    uint8_t sample_rate_index;
+    // the core sampling frequency in Hz, from the index or explicit.
+    uint32_t sample_rate;
+    // the channelConfiguration, 0 when defined by a program config element.
+    uint8_t channels;
+    // the samples of a frame at the core rate, 1024 or 960.
+    uint16_t frame_length;
+    // the extensionAudioObjectType, 5 for SBR, 0 if none.
+    uint8_t extension_object_type;
+    // 1 present, 0 absent, -1 not signaled, e.g. implicit SBR.
+    int8_t sbr;
+    int8_t ps;
+    // the output sampling frequency of SBR, 0 if none.
+    uint32_t extension_sample_rate;
+} AacConfig;
+
+/**
+ * decode the AudioSpecificConfig, the data of the aac sequence header,
+ * including the explicit frequency, the object type escape, and the
+ * explicit and backward compatible SBR/PS signaling.
+ */
+extern error_t aac_decode_config(const char* data, int size, AacConfig* config);
+
+/**
+ * the 7 bytes ADTS header of a raw frame of size bytes, without crc.
+ * only valid for object types 1 to 4 and channel configurations 1 to 7.
+ */
+extern void aac_write_adts_header(const AacConfig* config, int size, char* header);
+
+/**
+ * the AacConfig of a stream, decoded again only when the sequence header
+ * bytes change, so repeated sequence headers cost a compare.
+ */
+class AacConfigCache
+{
+private:
+    std::string bytes;
+    AacConfig config;
+    bool valid;
+public:
+    AacConfigCache();
+    ~AacConfigCache();
+public:
+    /**
+     * @param pchanged, output whether the config was decoded again.
+     */
+    error_t Update(const char* data, int size, bool* pchanged);
+    // the decoded config, NULL before a valid sequence header.
+    const AacConfig* Config();
+};
@@ -0,0 +1,274 @@
+#include "avc.h"
+#include "bitreader.h"
+#include "streamreader.h"
+#include <inttypes.h>
+
+double AvcConfig::Fps() const
+{
+    if (num_units_in_tick == 0 || time_scale == 0) {
+        return 0;
+    }
+    // a frame is two fields, so two ticks.
+    return (double)time_scale / (2.0 * num_units_in_tick);
+}
+
+// read the parameter sets of the record, each has a 16 bits size.
+static error_t read_parameter_sets(ContiguousReader* r, int count, std::vector<std::string>* sets)
+{
+    sets->clear();
+    for (int i = 0; i < count; i++) {
+        if (!r->require(2)) {
+            return errors_new(-1, "parameter set %d requires 2 only %" PRId64 " bytes", i, r->Remain());
+        }
+        uint16_t size = r->Read2Bytes();
+        if (size == 0 || !r->require(size)) {
+            return errors_new(-1, "parameter set %d requires %d only %" PRId64 " bytes", i, size, r->Remain());
+        }
+        sets->push_back(std::string(r->ReadSlice(size), size));
+    }
+    return errorsOK;
+}
+
+error_t avc_decode_config(const char* data, int size, AvcConfig* c)
+{
+    error_t err = errorsOK;
+
+    // configurationVersion, profile, compatibility, level,
+    // lengthSizeMinusOne and numOfSequenceParameterSets.
+    ContiguousReader r(const_cast<char*>(data), size);
+    if (!r.require(6)) {
+        return errors_new(-1, "AVCDecoderConfigurationRecord requires 6 only %d bytes", size);
+    }
+    uint8_t version = (uint8_t)r.Read1Byte();
+    if (version != 1) {
+        return errors_new(-1, "invalid configurationVersion %d", version);
+    }
+    c->profile = (uint8_t)r.Read1Byte();
+    c->compatibility = (uint8_t)r.Read1Byte();
+    c->level = (uint8_t)r.Read1Byte();
+    c->nalu_length_size = (uint8_t)((r.Read1Byte() & 0x03) + 1);
+    if (c->nalu_length_size == 3) {
+        return errors_new(-1, "invalid lengthSizeMinusOne 2");
+    }
+
+    int nb_sps = r.Read1Byte() & 0x1f;
+    if ((err = read_parameter_sets(&r, nb_sps, &c->sps)) != errorsOK) {
+        return errors_wrap(err, "read sps");
+    }
+    if (!r.require(1)) {
+        return errors_new(-1, "numOfPictureParameterSets requires 1 only %" PRId64 " bytes", r.Remain());
+    }
+    int nb_pps = (uint8_t)r.Read1Byte();
+    if ((err = read_parameter_sets(&r, nb_pps, &c->pps)) != errorsOK) {
+        return errors_wrap(err, "read pps");
+    }
+
+    c->width = c->height = 0;
+    c->chroma_format_idc = 1;
+    c->num_units_in_tick = c->time_scale = 0;
+    c->fixed_frame_rate = false;
+    if (!c->sps.empty()) {
+        const std::string& sps = c->sps[0];
+        if ((err = avc_decode_sps(sps.data(), (int)sps.size(), c)) != errorsOK) {
+            return errors_wrap(err, "decode sps");
+        }
+    }
+
+    return err;
+}
+
+// skip the scaling_list() of size coefficients.
+static void skip_scaling_list(BitReader* br, int size)
+{
+    int last = 8;
+    int next = 8;
+    for (int i = 0; i < size && next != 0; i++) {
+        int32_t delta = br->ReadSE();
+        next = (last + delta + 256) % 256;
+        last = (next == 0) ? last : next;
+    }
+}
+
+error_t avc_decode_sps(const char* data, int size, AvcConfig* c)
+{
+    if (size < 4 || (data[0] & 0x1f) != 7) {
+        return errors_new(-1, "invalid sps, size=%d", size);
+    }
+
+    // the rbsp after the NALU header, without emulation prevention bytes.
+    BitReader br(data + 1, size - 1, true);
+    uint8_t profile_idc = (uint8_t)br.ReadBits(8);
+    // constraint_set flags, level_idc
+    br.SkipBits(16);
+    // seq_parameter_set_id
+    br.ReadUE();
+
+    uint32_t chroma_format_idc = 1;
+    bool separate_colour_plane = false;
+    switch (profile_idc) {
+    case 100: case 110: case 122: case 244: case 44: case 83:
+    case 86: case 118: case 128: case 138: case 139: case 134: case 135:
+        chroma_format_idc = br.ReadUE();
+        if (chroma_format_idc == 3) {
+            separate_colour_plane = br.ReadBit();
+        }
+        // bit_depth_luma_minus8, bit_depth_chroma_minus8
+        br.ReadUE();
+        br.ReadUE();
+        // qpprime_y_zero_transform_bypass_flag
+        br.SkipBits(1);
+        if (br.ReadBit()) {
+            // seq_scaling_list_present_flag of each list.
+            int lists = (chroma_format_idc != 3) ? 8 : 12;
+            for (int i = 0; i < lists; i++) {
+                if (br.ReadBit()) {
+                    skip_scaling_list(&br, i < 6 ? 16 : 64);
+                }
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    if (chroma_format_idc > 3) {
+        return errors_new(-1, "invalid chroma_format_idc %u", chroma_format_idc);
+    }
+
+    // log2_max_frame_num_minus4
+    br.ReadUE();
+    uint32_t pic_order_cnt_type = br.ReadUE();
+    if (pic_order_cnt_type == 0) {
+        // log2_max_pic_order_cnt_lsb_minus4
+        br.ReadUE();
+    } else if (pic_order_cnt_type == 1) {
+        // delta_pic_order_always_zero_flag, offset_for_non_ref_pic,
+        // offset_for_top_to_bottom_field
+        br.SkipBits(1);
+        br.ReadSE();
+        br.ReadSE();
+        uint32_t cycle = br.ReadUE();
+        if (cycle > 255) {
+            return errors_new(-1, "invalid num_ref_frames_in_pic_order_cnt_cycle %u", cycle);
+        }
+        for (uint32_t i = 0; i < cycle; i++) {
+            br.ReadSE();
+        }
+    }
+    // max_num_ref_frames, gaps_in_frame_num_value_allowed_flag
+    br.ReadUE();
+    br.SkipBits(1);
+
+    uint32_t width_in_mbs = br.ReadUE() + 1;
+    uint32_t height_in_map_units = br.ReadUE() + 1;
+    uint32_t frame_mbs_only = br.ReadBit();
+    if (!frame_mbs_only) {
+        // mb_adaptive_frame_field_flag
+        br.SkipBits(1);
+    }
+    // direct_8x8_inference_flag
+    br.SkipBits(1);
+
+    uint32_t crop_left = 0, crop_right = 0, crop_top = 0, crop_bottom = 0;
+    if (br.ReadBit()) {
+        crop_left = br.ReadUE();
+        crop_right = br.ReadUE();
+        crop_top = br.ReadUE();
+        crop_bottom = br.ReadUE();
+    }
+
+    // the crop units of 7.4.2.1.1, by ChromaArrayType.
+    uint32_t chroma_array_type = separate_colour_plane ? 0 : chroma_format_idc;
+    uint32_t crop_x = 1, crop_y = 2 - frame_mbs_only;
+    if (chroma_array_type != 0) {
+        crop_x = (chroma_array_type == 3) ? 1 : 2;
+        crop_y *= (chroma_array_type == 1) ? 2 : 1;
+    }
+    uint64_t width = (uint64_t)width_in_mbs * 16;
+    uint64_t height = (uint64_t)(2 - frame_mbs_only) * height_in_map_units * 16;
+    uint64_t crop_w = (uint64_t)crop_x * (crop_left + crop_right);
+    uint64_t crop_h = (uint64_t)crop_y * (crop_top + crop_bottom);
+    if (crop_w >= width || crop_h >= height) {
+        return errors_new(-1, "invalid crop %" PRIu64 "x%" PRIu64 " of %" PRIu64 "x%" PRIu64, crop_w, crop_h, width, height);
+    }
+
+    uint32_t num_units_in_tick = 0, time_scale = 0;
+    bool fixed_frame_rate = false;
+    // vui_parameters_present_flag, only up to the timing info.
+    if (br.ReadBit()) {
+        if (br.ReadBit()) {
+            // aspect_ratio_idc, Extended_SAR has sar_width and sar_height.
+            if (br.ReadBits(8) == 255) {
+                br.SkipBits(32);
+            }
+        }
+        if (br.ReadBit()) {
+            // overscan_appropriate_flag
+            br.SkipBits(1);
+        }
+        if (br.ReadBit()) {
+            // video_format, video_full_range_flag
+            br.SkipBits(4);
+            if (br.ReadBit()) {
+                // colour_primaries, transfer_characteristics,
+                // matrix_coefficients
+                br.SkipBits(24);
+            }
+        }
+        if (br.ReadBit()) {
+            // chroma_sample_loc_type_top_field, bottom_field
+            br.ReadUE();
+            br.ReadUE();
+        }
+        if (br.ReadBit()) {
+            num_units_in_tick = br.ReadBits(32);
+            time_scale = br.ReadBits(32);
+            fixed_frame_rate = br.ReadBit();
+        }
+    }
+    if (br.Overflow()) {
+        return errors_new(-1, "sps requires more than %d bytes", size);
+    }
+
+    c->width = (uint32_t)(width - crop_w);
+    c->height = (uint32_t)(height - crop_h);
+    c->chroma_format_idc = (uint8_t)chroma_format_idc;
+    c->num_units_in_tick = num_units_in_tick;
+    c->time_scale = time_scale;
+    c->fixed_frame_rate = fixed_frame_rate;
+
+    return errorsOK;
+}
+
+AvcConfigCache::AvcConfigCache()
+{
+    valid = false;
+}
+
+AvcConfigCache::~AvcConfigCache()
+{
+}
+
+error_t AvcConfigCache::Update(const char* data, int size, bool* pchanged)
+{
+    error_t err = errorsOK;
+    *pchanged = false;
+
+    if (valid && bytes.size() == (size_t)size && memcmp(bytes.data(), data, size) == 0) {
+        return err;
+    }
+
+    valid = false;
+    bytes.assign(data, size);
+    if ((err = avc_decode_config(data, size, &config)) != errorsOK) {
+        return errors_wrap(err, "decode avc config");
+    }
+    valid = true;
+    *pchanged = true;
+
+    return err;
+}
+
+const AvcConfig* AvcConfigCache::Config()
+{
+    return valid ? &config : NULL;
+}
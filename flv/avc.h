@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "byteorder.h"
+#include "error.h"
+
+/**
+ * the decoded AVCDecoderConfigurationRecord of an avc stream, with the
+ * picture info of its first SPS.
+ * @see 5.2.4.1 AVCDecoderConfigurationRecord of ISO_IEC_14496-15
+ * @see 7.3.2.1 Sequence parameter set RBSP syntax of H.264
+ */
+typedef struct AvcConfig {
+    uint8_t profile;
+    uint8_t compatibility;
+    uint8_t level;
+    // the bytes of the NALU length prefix, lengthSizeMinusOne + 1.
+    uint8_t nalu_length_size;
+    // the raw parameter sets, each with its NALU header byte.
+    std::vector<std::string> sps;
+    std::vector<std::string> pps;
+    // the cropped picture size in pixels.
+    uint32_t width;
+    uint32_t height;
+    uint8_t chroma_format_idc;
+    // the VUI timing info, 0 when absent.
+    uint32_t num_units_in_tick;
+    uint32_t time_scale;
+    bool fixed_frame_rate;
+public:
+    // the frames per second of the VUI timing info, 0 when absent.
+    double Fps() const;
+} AvcConfig;
+
+/**
+ * decode the AVCDecoderConfigurationRecord, the data of the avc sequence
+ * header, and the first SPS in it.
+ */
+extern error_t avc_decode_config(const char* data, int size, AvcConfig* config);
+
+/**
+ * decode the picture size, chroma format and VUI timing of a SPS NALU,
+ * which starts at its NALU header byte.
+ */
+extern error_t avc_decode_sps(const char* data, int size, AvcConfig* config);
+
+/**
+ * the AvcConfig of a stream, decoded again only when the sequence header
+ * bytes change, so repeated sequence headers cost a compare.
+ */
+class AvcConfigCache
+{
+private:
+    std::string bytes;
+    AvcConfig config;
+    bool valid;
+public:
+    AvcConfigCache();
+    ~AvcConfigCache();
+public:
+    /**
+     * @param pchanged, output whether the config was decoded again.
+     */
+    error_t Update(const char* data, int size, bool* pchanged);
+    // the decoded config, NULL before a valid sequence header.
+    const AvcConfig* Config();
+};
+
+/**
+ * the nal_unit_type, @see Table 7-1 of H.264.
+ */
+typedef enum AvcNaluType {
+    AVC_NALU_NON_IDR = 1,
+    AVC_NALU_PARTITION_A = 2,
+    AVC_NALU_PARTITION_B = 3,
+    AVC_NALU_PARTITION_C = 4,
+    AVC_NALU_IDR = 5,
+    AVC_NALU_SEI = 6,
+    AVC_NALU_SPS = 7,
+    AVC_NALU_PPS = 8,
+    AVC_NALU_AUD = 9,
+    AVC_NALU_END_OF_SEQUENCE = 10,
+    AVC_NALU_END_OF_STREAM = 11,
+    AVC_NALU_FILLER = 12,
+} AvcNaluType;
+
+/**
+ * a NALU viewed in place, from its NALU header byte.
+ */
+typedef struct AvcNalu {
+    const char* data;
+    int size;
+    uint8_t type;
+    // nal_ref_idc, 0 for a NALU no other picture refers to.
+    uint8_t ref_idc;
+public:
+    inline bool IsIdr() const {
+        return type == AVC_NALU_IDR;
+    }
+    // a coded slice of a picture, IDR or not.
+    inline bool IsSlice() const {
+        return type >= AVC_NALU_NON_IDR && type <= AVC_NALU_IDR;
+    }
+    inline bool IsSei() const {
+        return type == AVC_NALU_SEI;
+    }
+} AvcNalu;
+
+/**
+ * walk the length prefixed NALUs of an avc tag in place, the prefix is
+ * nalu_length_size bytes, from the AVCDecoderConfigurationRecord.
+ * for example:
+ *      AvcNaluIterator it(payload.data, payload.size, config->nalu_length_size);
+ *      AvcNalu nalu;
+ *      while (it.Next(&nalu)) {
+ *          if (nalu.IsIdr()) ...
+ *      }
+ *      if (it.Malformed()) ...
+ */
+class AvcNaluIterator
+{
+private:
+    const char* p;
+    const char* end;
+    int length_size;
+    bool malformed;
+public:
+    AvcNaluIterator(const char* data, int size, int nalu_length_size) {
+        p = data;
+        end = data + (size > 0 ? size : 0);
+        length_size = nalu_length_size;
+        malformed = (length_size != 1 && length_size != 2 && length_size != 4);
+    }
+public:
+    /**
+     * the next NALU, false at the end or when the next length is out of
+     * the payload, see Malformed().
+     */
+    inline bool Next(AvcNalu* nalu) {
+        if (malformed || end - p < length_size) {
+            malformed = malformed || (p != end);
+            return false;
+        }
+
+        uint32_t size = 0;
+        if (length_size == 4) {
+            size = be_read32(p);
+        } else if (length_size == 2) {
+            size = be_read16(p);
+        } else {
+            size = (uint8_t)*p;
+        }
+        p += length_size;
+        if (size == 0 || size > (uint32_t)(end - p)) {
+            malformed = true;
+            return false;
+        }
+
+        nalu->data = p;
+        nalu->size = (int)size;
+        nalu->type = (uint8_t)(p[0] & 0x1f);
+        nalu->ref_idc = (uint8_t)((p[0] >> 5) & 0x03);
+        p += size;
+        return true;
+    }
+    // whether the walk stopped on bytes which are not a whole NALU.
+    inline bool Malformed() {
+        return malformed;
+    }
+};
@@ -0,0 +1,329 @@
+#include "flvindex.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// the layout of the sidecar file, in host byte order:
+//      FLVIndexFileHeader, 64 bytes
+//      int64_t offsets[count]
+//      int64_t keyframe_offsets[keyframe_count]
+//      uint32_t timestamps[count]
+//      uint32_t keyframe_times[keyframe_count]
+//      uint32_t sizes[count]
+//      uint8_t kinds[count]
+//      uint8_t flags[count]
+// every column is naturally aligned, so it's used in place when mapped.
+// bump the version whenever the layout changes.
+#define FLV_INDEX_MAGIC "FLVINDEX"
+#define FLV_INDEX_VERSION 3
+#define FLV_INDEX_BYTE_ORDER 0x01020304
+
+typedef struct FLVIndexFileHeader {
+    char magic[8];
+    uint32_t version;
+    // FLV_INDEX_BYTE_ORDER, to detect a sidecar from the other endian.
+    uint32_t byte_order;
+    // the key of the flv the index was built from, mtime in nanoseconds.
+    int64_t file_size;
+    int64_t file_mtime;
+    int64_t count;
+    int64_t keyframe_count;
+    uint8_t reserved[16];
+} FLVIndexFileHeader;
+
+static_assert(sizeof(FLVIndexFileHeader) == 64, "FLVIndexFileHeader must be 64 bytes");
+
+// bytes of all columns of one tag, and of one keyframe.
+#define FLV_INDEX_BYTES_PER_TAG (8 + 4 + 4 + 1 + 1)
+#define FLV_INDEX_BYTES_PER_KEYFRAME (8 + 4)
+
+FLVTagIndex::FLVTagIndex()
+{
+    sidecar = NULL;
+    useBuiltColumns();
+}
+
+FLVTagIndex::~FLVTagIndex()
+{
+    freep(sidecar);
+}
+
+error_t FLVTagIndex::Build(FLVParser* parser)
+{
+    error_t err = errorsOK;
+
+    Clear();
+
+    FLVTagRecord records[256];
+    int nb_records = 0;
+    while (true) {
+        if ((err = parser->DecodeTagRecords(records, 256, &nb_records)) != errorsOK) {
+            return errors_wrap(err, "decode tag records");
+        }
+        if (nb_records <= 0) {
+            break;
+        }
+
+        for (int i = 0; i < nb_records; i++) {
+            FLVTagRecord& r = records[i];
+            built_offsets.push_back(r.offset);
+            built_timestamps.push_back(r.timestamp);
+            built_sizes.push_back(r.data_size);
+            built_kinds.push_back(r.kind);
+            built_flags.push_back(r.flags);
+
+            if (r.kind == TAG_KIND_VIDEO && (r.flags & TAG_FLAG_KEYFRAME)
+                && !(r.flags & TAG_FLAG_SEQUENCE_HEADER)) {
+                built_keyframe_offsets.push_back(r.offset);
+                built_keyframe_times.push_back(r.timestamp);
+            }
+        }
+    }
+
+    useBuiltColumns();
+    return err;
+}
+
+void FLVTagIndex::Clear()
+{
+    freep(sidecar);
+    built_offsets.clear();
+    built_timestamps.clear();
+    built_sizes.clear();
+    built_kinds.clear();
+    built_flags.clear();
+    built_keyframe_offsets.clear();
+    built_keyframe_times.clear();
+    useBuiltColumns();
+}
+
+void FLVTagIndex::useBuiltColumns()
+{
+    count = (int)built_offsets.size();
+    offsets = built_offsets.data();
+    timestamps = built_timestamps.data();
+    sizes = built_sizes.data();
+    kinds = built_kinds.data();
+    flags = built_flags.data();
+    keyframe_count = (int)built_keyframe_offsets.size();
+    keyframe_offsets = built_keyframe_offsets.data();
+    keyframe_times = built_keyframe_times.data();
+}
+
+int FLVTagIndex::Count()
+{
+    return count;
+}
+
+error_t FLVTagIndex::Save(const char* path, int64_t file_size, int64_t file_mtime)
+{
+    error_t err = errorsOK;
+
+    FLVIndexFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FLV_INDEX_MAGIC, sizeof(header.magic));
+    header.version = FLV_INDEX_VERSION;
+    header.byte_order = FLV_INDEX_BYTE_ORDER;
+    header.file_size = file_size;
+    header.file_mtime = file_mtime;
+    header.count = count;
+    header.keyframe_count = keyframe_count;
+
+    // a unique temporary file in the same directory, so concurrent savers
+    // never write the same file and the rename stays on one filesystem.
+    string tmp = string(path) + ".XXXXXX";
+    int fd = mkstemp(&tmp[0]);
+    if (fd < 0) {
+        return errors_new(-1, "create %s failed", tmp.c_str());
+    }
+    // mkstemp() creates it private, the sidecar is readable like the flv.
+    fchmod(fd, 0644);
+    FILE* fp = fdopen(fd, "wb");
+    if (!fp) {
+        close(fd);
+        ::remove(tmp.c_str());
+        return errors_new(-1, "open %s failed", tmp.c_str());
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    ok = ok && fwrite(offsets, sizeof(int64_t), count, fp) == (size_t)count;
+    ok = ok && fwrite(keyframe_offsets, sizeof(int64_t), keyframe_count, fp) == (size_t)keyframe_count;
+    ok = ok && fwrite(timestamps, sizeof(uint32_t), count, fp) == (size_t)count;
+    ok = ok && fwrite(keyframe_times, sizeof(uint32_t), keyframe_count, fp) == (size_t)keyframe_count;
+    ok = ok && fwrite(sizes, sizeof(uint32_t), count, fp) == (size_t)count;
+    ok = ok && fwrite(kinds, sizeof(uint8_t), count, fp) == (size_t)count;
+    ok = ok && fwrite(flags, sizeof(uint8_t), count, fp) == (size_t)count;
+    // durable before it's visible, a crash never leaves a torn sidecar
+    // which passes the key check.
+    ok = ok && fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok || rename(tmp.c_str(), path) != 0) {
+        ::remove(tmp.c_str());
+        return errors_new(-1, "write %s failed", path);
+    }
+
+    return err;
+}
+
+error_t FLVTagIndex::Load(const char* path, int64_t file_size, int64_t file_mtime)
+{
+    error_t err = errorsOK;
+
+    Clear();
+
+    MmapFile* file = new MmapFile();
+    if ((err = file->Open(path)) != errorsOK) {
+        freep(file);
+        return errors_wrap(err, "map %s", path);
+    }
+
+    // validate the layout and the key, before using any column.
+    FLVIndexFileHeader* header = (FLVIndexFileHeader*)file->Data();
+    if (file->Size() < (int64_t)sizeof(FLVIndexFileHeader)
+        || memcmp(header->magic, FLV_INDEX_MAGIC, sizeof(header->magic)) != 0
+        || header->version != FLV_INDEX_VERSION
+        || header->byte_order != FLV_INDEX_BYTE_ORDER) {
+        freep(file);
+        return errors_new(-1, "invalid index %s", path);
+    }
+    if (header->file_size != file_size || header->file_mtime != file_mtime) {
+        freep(file);
+        return errors_new(-1, "stale index %s", path);
+    }
+    if (header->count < 0 || header->count > INT32_MAX
+        || header->keyframe_count < 0 || header->keyframe_count > header->count
+        || file->Size() != (int64_t)sizeof(FLVIndexFileHeader) + header->count * FLV_INDEX_BYTES_PER_TAG
+            + header->keyframe_count * FLV_INDEX_BYTES_PER_KEYFRAME) {
+        // the header is in the mapping, read it before unmapping.
+        int64_t nb_tags = header->count;
+        freep(file);
+        return errors_new(-1, "corrupt index %s, count=%" PRId64, path, nb_tags);
+    }
+
+    sidecar = file;
+    count = (int)header->count;
+    keyframe_count = (int)header->keyframe_count;
+
+    const char* p = file->Data() + sizeof(FLVIndexFileHeader);
+    offsets = (const int64_t*)p;
+    p += count * sizeof(int64_t);
+    keyframe_offsets = (const int64_t*)p;
+    p += keyframe_count * sizeof(int64_t);
+    timestamps = (const uint32_t*)p;
+    p += count * sizeof(uint32_t);
+    keyframe_times = (const uint32_t*)p;
+    p += keyframe_count * sizeof(uint32_t);
+    sizes = (const uint32_t*)p;
+    p += count * sizeof(uint32_t);
+    kinds = (const uint8_t*)p;
+    p += count * sizeof(uint8_t);
+    flags = (const uint8_t*)p;
+
+    // lookups are binary searches, the pages are touched at random.
+    sidecar->Advise(MADV_RANDOM);
+
+    return err;
+}
+
+error_t FLVTagIndex::FileKey(const char* path, int64_t* psize, int64_t* pmtime)
+{
+    struct stat st;
+    if (stat(path, &st) < 0) {
+        return errors_new(-1, "stat %s failed", path);
+    }
+    *psize = (int64_t)st.st_size;
+#ifdef __APPLE__
+    const struct timespec& mtime = st.st_mtimespec;
+#else
+    const struct timespec& mtime = st.st_mtim;
+#endif
+    *pmtime = (int64_t)mtime.tv_sec * 1000000000 + mtime.tv_nsec;
+    return errorsOK;
+}
+
+string FLVTagIndex::SidecarPath(const char* path)
+{
+    return string(path) + ".idx";
+}
+
+const int64_t* FLVTagIndex::Offsets()
+{
+    return offsets;
+}
+
+const uint32_t* FLVTagIndex::Timestamps()
+{
+    return timestamps;
+}
+
+const uint8_t* FLVTagIndex::Kinds()
+{
+    return kinds;
+}
+
+const uint8_t* FLVTagIndex::Flags()
+{
+    return flags;
+}
+
+const uint32_t* FLVTagIndex::Sizes()
+{
+    return sizes;
+}
+
+bool FLVTagIndex::IsKeyframe(int index)
+{
+    assert(index >= 0 && index < count);
+    return (flags[index] & TAG_FLAG_KEYFRAME) != 0;
+}
+
+int FLVTagIndex::KeyframeCount()
+{
+    return keyframe_count;
+}
+
+const int64_t* FLVTagIndex::KeyframeOffsets()
+{
+    return keyframe_offsets;
+}
+
+const uint32_t* FLVTagIndex::KeyframeTimes()
+{
+    return keyframe_times;
+}
+
+int FLVTagIndex::FindByTime(uint32_t ms)
+{
+    // the first tag after ms, the one before it is the answer.
+    const uint32_t* it = std::upper_bound(timestamps, timestamps + count, ms);
+    return (int)(it - timestamps) - 1;
+}
+
+void FLVTagIndex::FindRange(uint32_t from, uint32_t to, int* pfirst, int* plast)
+{
+    const uint32_t* end = timestamps + count;
+    const uint32_t* first = std::lower_bound(timestamps, end, from);
+    const uint32_t* last = std::lower_bound(first, end, to > from ? to : from);
+    *pfirst = (int)(first - timestamps);
+    *plast = (int)(last - timestamps);
+}
+
+int FLVTagIndex::FindByOffset(int64_t offset)
+{
+    const int64_t* end = offsets + count;
+    const int64_t* it = std::lower_bound(offsets, end, offset);
+    if (it == end || *it != offset) {
+        return -1;
+    }
+    return (int)(it - offsets);
+}
+
+int FLVTagIndex::FindKeyframe(uint32_t ms)
+{
+    const uint32_t* it = std::upper_bound(keyframe_times, keyframe_times + keyframe_count, ms);
+    return (int)(it - keyframe_times) - 1;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <vector>
+#include "flvparser.h"
+#include "mmapfile.h"
+
+/**
+ * the index of all tags of a flv, built in one pass and stored as
+ * struct-of-arrays columns, so lookups are binary searches over
+ * contiguous arrays instead of reparsing the file.
+ * the index can be saved to a sidecar file(movie.flv.idx) and mapped
+ * back later, the columns are then used in place without deserializing.
+ * @remark timestamps are assumed nondecreasing in file order, which is
+ *       how muxers write them; lookups are approximate otherwise.
+ */
+class FLVTagIndex
+{
+private:
+    int count;
+    // offset of each tag header from the start of the flv.
+    const int64_t* offsets;
+    // timestamp in milliseconds of each tag.
+    const uint32_t* timestamps;
+    // DataSize of each tag.
+    const uint32_t* sizes;
+    // FLVTagKind of each tag.
+    const uint8_t* kinds;
+    // FLVTagFlag bits of each tag, the keyframe bit and so on.
+    const uint8_t* flags;
+    // the keyframe table, offset and timestamp of each video keyframe,
+    // sequence headers excluded.
+    int keyframe_count;
+    const int64_t* keyframe_offsets;
+    const uint32_t* keyframe_times;
+private:
+    // the columns point to these when built by Build().
+    std::vector<int64_t> built_offsets;
+    std::vector<uint32_t> built_timestamps;
+    std::vector<uint32_t> built_sizes;
+    std::vector<uint8_t> built_kinds;
+    std::vector<uint8_t> built_flags;
+    std::vector<int64_t> built_keyframe_offsets;
+    std::vector<uint32_t> built_keyframe_times;
+    // the columns point into this when loaded by Load().
+    MmapFile* sidecar;
+public:
+    FLVTagIndex();
+    virtual ~FLVTagIndex();
+public:
+    /**
+     * build the index from the current position of the parser to the end,
+     * the columns are cleared first.
+     */
+    error_t Build(FLVParser* parser);
+    void Clear();
+    int Count();
+public:
+    /**
+     * save the index to a sidecar file, keyed by the size and mtime of
+     * the flv it was built from. written to a unique temporary file,
+     * synced and renamed, so readers never map a partial index.
+     */
+    error_t Save(const char* path, int64_t file_size, int64_t file_mtime);
+    /**
+     * map a sidecar saved by Save(), the columns point into the mapping.
+     * fails when the layout version or the key of the flv does not
+     * match, the index is empty then and should be rebuilt.
+     */
+    error_t Load(const char* path, int64_t file_size, int64_t file_mtime);
+    /**
+     * the key of a flv file, its size and mtime in nanoseconds, so a file
+     * rewritten within the same second is still detected.
+     */
+    static error_t FileKey(const char* path, int64_t* psize, int64_t* pmtime);
+    /**
+     * the sidecar path of a flv, for example movie.flv.idx
+     */
+    static string SidecarPath(const char* path);
+public:
+    const int64_t* Offsets();
+    const uint32_t* Timestamps();
+    const uint8_t* Kinds();
+    const uint8_t* Flags();
+    const uint32_t* Sizes();
+    bool IsKeyframe(int index);
+    int KeyframeCount();
+    const int64_t* KeyframeOffsets();
+    const uint32_t* KeyframeTimes();
+public:
+    /**
+     * find the last tag whose timestamp is not after ms.
+     * @return the tag index, -1 if all tags are after ms.
+     */
+    int FindByTime(uint32_t ms);
+    /**
+     * find the tags whose timestamp is in [from, to).
+     * @param pfirst, plast output the tag indexes [first, last),
+     *       first == last when no tag matches.
+     */
+    void FindRange(uint32_t from, uint32_t to, int* pfirst, int* plast);
+    /**
+     * find the tag whose header starts at offset.
+     * @return the tag index, -1 if not found.
+     */
+    int FindByOffset(int64_t offset);
+    /**
+     * find the last video keyframe whose timestamp is not after ms.
+     * @return the index in the keyframe table, -1 if all keyframes are after ms.
+     */
+    int FindKeyframe(uint32_t ms);
+private:
+    void useBuiltColumns();
+};
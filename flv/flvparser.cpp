@@ -1,9 +1,26 @@
 #include "flvparser.h"
+#include "flvindex.h"
+#include "byteorder.h"
 
-FLVParser::FLVParser(char*&& buf, int len)
+FLVParser::FLVParser(char*&& buf, int64_t len)
 {
-    sb = new StreamBuf(buf, len);
+    sb = new ContiguousReader(buf, len);
+    header_parsed = false;
+    visitor = NULL;
+    index = NULL;
+    unit_block = NULL;
+    unit_stable = true;
+}
 
+FLVParser::FLVParser()
+{
+    sb = NULL;
+    header_parsed = false;
+    visitor = NULL;
+    index = NULL;
+    carry = make_shared<string>();
+    unit_block = NULL;
+    unit_stable = false;
 }
 
 FLVParser::~FLVParser()
@@ -13,9 +30,29 @@ FLVParser::~FLVParser()
     }
 }
 
+void FLVParser::SetVisitor(FLVVisitor* v) {
+    visitor = v;
+}
+
+error_t FLVParser::failed(error_t err) {
+    if (visitor) {
+        visitor->onError(err);
+    }
+    return err;
+}
+
+void FLVParser::report(error_t err) {
+    if (visitor) {
+        visitor->onError(err);
+    }
+    errors_free(err);
+}
+
 error_t FLVParser::parserFLVHeader() {
-    assert(sb->Remain() > minByteRequired);
     error_t err = errorsOK;
+    if (!sb->require(minByteRequired)) {
+        return errors_new(ERROR_STREAM_EOF, "flv header requires %d only %" PRId64 " bytes", minByteRequired, sb->Remain());
+    }
 
     char f = sb->Read1Byte();
     char l = sb->Read1Byte();
@@ -23,6 +60,9 @@ error_t FLVParser::parserFLVHeader() {
     if (f != 0x46 || l != 0x4c || v != 0x56) { // FLV
         return errors_new(-1, "signature check failed");
     }
+    header.signature[0] = f;
+    header.signature[1] = l;
+    header.signature[2] = v;
 
     header.version = sb->Read1Byte();
 
@@ -31,208 +71,568 @@ error_t FLVParser::parserFLVHeader() {
     header.type_flags_video = (0x01 & avtag);
 
     header.data_offset = sb->Read4Bytes();
+    if (header.data_offset < (uint32_t)minByteRequired || header.data_offset > (uint32_t)maxDataOffset) {
+        return errors_new(-1, "invalid data offset %u", header.data_offset);
+    }
     // point to body.
-    sb->Skip(header.data_offset - sb->Offset());
-    return err;
-}
-
-uint32_t FLVParser::FLVTagHeader::Timestamp() {
-    return (timestamp_extended << 24) | timestamp;
-}
+    int64_t size = header.data_offset - sb->Offset();
+    if (!sb->require(size)) {
+        return errors_new(ERROR_STREAM_EOF, "data offset %u out of range", header.data_offset);
+    }
+    sb->Skip(size);
 
-string FLVParser::FLVTagHeader::toString() {
-    stringstream ss;
-    ss << "flv tag header:\n "
-       << "tag_type: " << tag_type_mp[tag_type] << LF
-       << "data_size: " << to_string(data_size) << LF
-       << "timestamp: " << to_string(timestamp) << LF
-       << "timestamp_extended: " << to_string(timestamp_extended) << LF
-       << "timestamp(): " << to_string(Timestamp()) << LF
-       << "stream_id: " << to_string(stream_id) << LF;
-    return ss.str();
+    if (visitor) {
+        err = visitor->onHeader(header);
+    }
+    return err;
 }
 
 error_t FLVParser::parserFLVTagHeader() {
     error_t err = errorsOK;
-    tag_header.tag_type = (TagTypeE)sb->Read1Byte();
-    tag_header.data_size = sb->Read3Bytes();
-    tag_header.timestamp = sb->Read3Bytes();
-    tag_header.timestamp_extended = sb->Read1Byte();
-    tag_header.stream_id = sb->Read3Bytes();
+
+    // PreviousTagSize(4) + tag header(11), checked once.
+    UncheckedCursor c;
+    if (!sb->Take(15, &c)) {
+        return errors_new(ERROR_STREAM_EOF, "tag header requires 15 only %" PRId64 " bytes", sb->Remain());
+    }
+    tag_header.previous_tag_size = c.Read4Bytes();
+    tag_header.tag_type = (TagTypeE)c.Read1Byte();
+    tag_header.data_size = c.Read3Bytes();
+    tag_header.timestamp = c.Read3Bytes();
+    tag_header.timestamp_extended = c.Read1Byte();
+    tag_header.stream_id = c.Read3Bytes();
     return err;
 }
 
-error_t FLVParser::parseFLVVideoTag() {
+error_t FLVParser::parseFLVVideoTag(UncheckedCursor& c) {
     error_t err = errorsOK;
-    int pos = sb->Offset();
+    if (c.Remain() < 1) {
+        return errors_new(-1, "video tag requires 1 only %" PRId64 " bytes", c.Remain());
+    }
 
-    uint8_t type = sb->Read1Byte();
+    uint8_t type = c.Read1Byte();
     video_tag.frame_type  = (type & 0xf0) >> 4;
     video_tag.codec_id = (type & 0x0f);
+    video_tag.avc_packet_type = 0;
+    video_tag.composition_time = 0;
     if (video_tag.codec_id == 7) { // avc
-        video_tag.avc_packet_type = sb->Read1Byte();
-        video_tag.composition_time = sb->Read3Bytes();
+        if (c.Remain() < 4) {
+            return errors_new(-1, "avc tag requires 4 only %" PRId64 " bytes", c.Remain());
+        }
+        video_tag.avc_packet_type = c.Read1Byte();
+        video_tag.composition_time = c.Read3Bytes();
     }
 
-    int offset = sb->Offset() - pos;
-    // skip video data/
-    sb->Skip(tag_header.data_size - offset);
+    // the video data, viewed in place.
+    FLVPayload payload;
+    viewPayload(c, &payload);
+
+    // avc sequence header, decoded only when it differs from the last
+    // one of the stream.
+    video_tag.avc_config = NULL;
+    if (video_tag.codec_id == 7) {
+        if (video_tag.avc_packet_type == 0) {
+            bool changed = false;
+            // a broken record is reported and the stream goes on without
+            // the config.
+            if ((err = avc_config.Update(payload.data, payload.size, &changed)) != errorsOK) {
+                report(errors_wrap(err, "avc sequence header"));
+            }
+        }
+        video_tag.avc_config = avc_config.Config();
+    }
+
+    if (visitor) {
+        err = visitor->onVideo(tag_header, video_tag, payload);
+    }
     return err;
 }
 
-error_t FLVParser::parseFLVAudioTag() {
+void FLVParser::viewPayload(UncheckedCursor& c, FLVPayload* payload) {
+    payload->size = (int)c.Remain();
+    payload->data = c.ReadSlice(payload->size);
+    payload->block = unit_block;
+    payload->stable = unit_stable;
+}
+
+error_t FLVParser::parseFLVAudioTag(UncheckedCursor& c) {
     error_t err = errorsOK;
-    int pos = sb->Offset();
+    if (c.Remain() < 1) {
+        return errors_new(-1, "audio tag requires 1 only %" PRId64 " bytes", c.Remain());
+    }
 
-    uint8_t pa = sb->Read1Byte();
+    uint8_t pa = c.Read1Byte();
     audio_tag.sound_format = (SoundFormatE)(pa >> 4);
     audio_tag.sound_rate = (pa & 0x0f) >> 2;
     audio_tag.sound_size = (pa & 0x02) >> 1;
     audio_tag.sound_type = (pa & 0x01);
-    audio_tag.aac_packet_type = sb->Read1Byte();
-    // aac sequence header
-    if (audio_tag.aac_packet_type == 0) {
-        uint8_t audioObjectType = sb->Read1Byte();
-        uint8_t aac_sample_rate = sb->Read1Byte();
-        
-        audio_tag.aac_channels = (aac_sample_rate >> 3) & 0x0f;
-        audio_tag.aac_sample_rate = (AacSampleRateIndex)(((audioObjectType << 1) & 0x0e) | ((aac_sample_rate >> 7) & 0x01));
-        // @todo if aac_sample_rate == 0xf 
-        // sampling frequency will be present by 24bit as flowing.
-        // read 24bit, and reparse sampling frequency.
-        audioObjectType = (audioObjectType >> 3) & 0x1f;
-        audio_tag.aac_object = (AacObjectType)audioObjectType;
-        cout << audio_tag.toString() << endl;
-    }
-
-    int offset = sb->Offset() - pos;
-    // skip audio data/
-    sb->Skip(tag_header.data_size - offset);
+    audio_tag.aac_packet_type = 0;
+    audio_tag.aac_config = NULL;
+    // only aac has the packet type.
+    bool aac = audio_tag.sound_format == AAC;
+    if (aac) {
+        if (c.Remain() < 1) {
+            return errors_new(-1, "aac tag requires 1 only %" PRId64 " bytes", c.Remain());
+        }
+        audio_tag.aac_packet_type = c.Read1Byte();
+    }
+
+    // the sound data, viewed in place.
+    FLVPayload payload;
+    viewPayload(c, &payload);
+
+    // aac sequence header, the AudioSpecificConfig, decoded only when
+    // it differs from the last one of the stream.
+    if (aac && audio_tag.aac_packet_type == 0) {
+        bool changed = false;
+        // a broken config is reported and the stream goes on without it.
+        if ((err = aac_config.Update(payload.data, payload.size, &changed)) != errorsOK) {
+            report(errors_wrap(err, "aac sequence header"));
+        }
+        const AacConfig* config = aac_config.Config();
+        if (config) {
+            // HE-AAC is reported as such, whatever the signaling.
+            audio_tag.aac_object = (AacObjectType)config->object_type;
+            if (config->sbr == 1) {
+                audio_tag.aac_object = config->ps == 1 ? AacObjectTypeAacHEV2 : AacObjectTypeAacHE;
+            }
+            audio_tag.aac_sample_rate = (AacSampleRateIndex)config->sample_rate_index;
+            audio_tag.aac_sample_frequency = config->sample_rate_index == 0x0f ? config->sample_rate : 0;
+            audio_tag.aac_channels = config->channels;
+        }
+    }
+    if (aac) {
+        audio_tag.aac_config = aac_config.Config();
+    }
+
+    if (visitor) {
+        err = visitor->onAudio(tag_header, audio_tag, payload);
+    }
     return err;
 }
 
-string FLVParser::FLVTagAudio::toString() {
-    stringstream ss;
-    ss << "audio tag header:" << LF 
-        << "format: " << sound_format_mp[sound_format] << LF
-        << "rate: " << sound_rate_mp[sound_rate] << LF
-        << "sound_size: " << sound_size_mp[sound_size] << LF
-        << "sound_type: " << sound_type_mp[sound_type] << LF;
-    if (sound_format == AAC) {
-        ss << "packet type: " << aac_packet_type_mp[aac_packet_type] << LF; 
-        if (aac_packet_type == 0) {
-            ss << "aac_packet_type: " << aac_object_mp[aac_object] << LF
-                << "aac_sample_rate:" << aac_sample_rate_mp[aac_sample_rate] << LF
-                << "aac_channels: " << to_string(aac_channels) << LF; 
+error_t FLVParser::parseFLVScriptTag(UncheckedCursor& c) {
+    error_t err = errorsOK;
+
+    // the AMF0 data is left to the visitor, decode it only when needed.
+    FLVPayload payload;
+    viewPayload(c, &payload);
+
+    if (visitor) {
+        err = visitor->onScript(tag_header, payload);
+    }
+    return err;
+}
+
+/*
+Signature
+*/
+error_t FLVParser::Parse() {
+    error_t err = errorsOK;
+
+    // a push mode parser is driven by Feed().
+    if (!sb) {
+        return errors_new(-1, "parse requires a contiguous source");
+    }
+
+    if (!header_parsed) {
+        if ((err = parserFLVHeader()) != errorsOK) {
+            return failed(errors_wrap(err, "parser flv header failed"));
+        }
+        header_parsed = true;
+    }
+
+    // parse flv body.
+    while (sb->Remain() > 4) {
+        if ((err = parseFLVTag()) != errorsOK) {
+            return failed(errors_wrap(err, "parse flv tag failed"));
         }
     }
-    return ss.str();
+
+    return err;
 }
 
-string FLVParser::FLVTagVideo::toString() {
-    stringstream ss;
-    ss << "video tag header: " << LF
-        << "frame_type: " << frame_type_mp[frame_type] << LF
-        << "codec id: " << codec_id_mp[codec_id] << LF;
-    if (codec_id == 7) {
-        ss << "avc_packet_type: " << avc_packet_type_mp[avc_packet_type] << LF
-            << "composition_time" << to_string(composition_time) << LF;
+error_t FLVParser::parseFLVTag() {
+    error_t err = errorsOK;
+
+    if ((err = parserFLVTagHeader()) != errorsOK) {
+        return errors_wrap(err, "parse tag header");
+    }
+
+    // the only bounds check of the tag data, the fields are read from
+    // the cursor unchecked.
+    UncheckedCursor c;
+    if (!sb->Take(tag_header.data_size, &c)) {
+        return errors_new(ERROR_STREAM_EOF, "tag data requires %u only %" PRId64 " bytes", (uint32_t)tag_header.data_size, sb->Remain());
+    }
+
+    switch (tag_header.tag_type)
+    {
+    case TAG_TYPE_VIDEO:
+        err = parseFLVVideoTag(c);
+        break;
+    case TAG_TYPE_AUDIO: 
+        err = parseFLVAudioTag(c); 
+        break;
+    case TAG_TYPE_SCRIPT: 
+        err = parseFLVScriptTag(c);
+        break;
+    default:
+        // reserved tag type, the data is skipped.
+        break;
     }
-    return ss.str();
+    return err;
+}
+
+int FLVParser::unitSize(const char* p, int64_t n) {
+    if (!header_parsed) {
+        // signature(3) + version(1) + flags(1) + data_offset(4)
+        if (n < minByteRequired) {
+            return minByteRequired;
+        }
+        // an invalid offset is rejected by parserFLVHeader() on the first
+        // 9 bytes, never buffered.
+        uint32_t data_offset = be_read32(p + 5);
+        if (data_offset < (uint32_t)minByteRequired || data_offset > (uint32_t)maxDataOffset) {
+            return minByteRequired;
+        }
+        return (int)data_offset;
+    }
+
+    // PreviousTagSize(4) + tag header(11) + data.
+    if (n < 15) {
+        return 15;
+    }
+    uint32_t data_size = be_read24(p + 5);
+    return 15 + (int)data_size;
 }
 
-error_t FLVParser::parseFLVScriptTag() {
+error_t FLVParser::parseUnit(const char* p, int len, const shared_ptr<string>* block) {
     error_t err = errorsOK;
-    int pos = sb->Offset();
 
+    // parse the unit in place, the stream never writes.
+    ContiguousReader unit(const_cast<char*>(p), len);
+    ContiguousReader* owner = sb;
+    sb = &unit;
+    unit_block = block;
     shared_ptr<void> autoFree(nullptr, [&](void*) {
-        int offset = sb->Offset() - pos;
-        sb->Skip(tag_header.data_size - offset);
+        sb = owner;
+        unit_block = NULL;
     });
 
-    while (sb->Offset() - pos < tag_header.data_size) {
-        Amf0Any* any;
-        error_t err = amf0_read_any(sb, &any);
-        if (err != errorsOK) {
-            return errors_wrap(err, "failed read amf0");
+    if (!header_parsed) {
+        if ((err = parserFLVHeader()) != errorsOK) {
+            return failed(errors_wrap(err, "parser flv header failed"));
         }
-        if (any->is_string()) {
-            auto any_str = dynamic_cast<Amf0String*>(any);
-            if (any_str) {
-                cout << any_str->value << endl;
+        header_parsed = true;
+        return err;
+    }
+
+    if ((err = parseFLVTag()) != errorsOK) {
+        return failed(errors_wrap(err, "parse flv tag failed"));
+    }
+    return err;
+}
+
+string* FLVParser::carryBuffer() {
+    // a payload pinned by the visitor still refers to the block.
+    if (carry.use_count() > 1) {
+        carry = make_shared<string>();
+    }
+    return carry.get();
+}
+
+error_t FLVParser::Feed(const char* data, int64_t size) {
+    error_t err = errorsOK;
+
+    while (size > 0) {
+        // complete the unit in the carry-over buffer first.
+        if (!carry->empty()) {
+            string* buf = carry.get();
+            int need = unitSize(buf->data(), (int)buf->size());
+            while (need > (int)buf->size() && size > 0) {
+                int n = (int)min((int64_t)(need - (int)buf->size()), size);
+                buf->append(data, n);
+                data += n;
+                size -= n;
+                need = unitSize(buf->data(), (int)buf->size());
             }
-        } else if (any->is_ecma_array()) {
-            auto array = dynamic_cast<Amf0EcmaArray*>(any);
-            if (array) {
-                for (int i = 0; i < array->count(); i++) {
-                    cout << "key at " << to_string(i) << " is " << array->key_at(i) << endl;
-                    auto value = array->value_at(i);
-                    if (Amf0String* str = dynamic_cast<Amf0String*> (value); str != nullptr) {
-                        cout << "value at " << to_string(i) << "is " << value->to_str() << endl;
-                    } else if (Amf0Number* num = dynamic_cast<Amf0Number*>(value); num != nullptr) {
-                        cout << "value at " << to_string(i) << "is " << value->to_number() << endl;
-                    } else if (Amf0Boolean* b = dynamic_cast<Amf0Boolean*>(value); b != nullptr) {
-                        cout << "value at " << to_string(i) << "is " << value->to_boolean() << endl;
-                    } else if (Amf0Date* b = dynamic_cast<Amf0Date*>(value); b != nullptr) {
-                        cout << "value at " << to_string(i) << "is " << value->to_date() << endl;
-                    } 
-                }
-            } 
-        } else {
-            // @todo other amf0 type.
+            if (need > (int)buf->size()) {
+                break;
+            }
+
+            err = parseUnit(buf->data(), need, &carry);
+            carryBuffer()->clear();
+            if (err != errorsOK) {
+                return errors_wrap(err, "parse carry-over unit");
+            }
+            continue;
+        }
+
+        // the unit is complete in data, no copy.
+        int need = unitSize(data, size);
+        if (need > size) {
+            carryBuffer()->assign(data, size);
+            break;
+        }
+        if ((err = parseUnit(data, need, NULL)) != errorsOK) {
+            return errors_wrap(err, "parse unit");
         }
-        freep(any);
+        data += need;
+        size -= need;
     }
-    
+
     return err;
 }
 
-/*
-Signature
-*/
-error_t FLVParser::Parse() {
-    error_t err = parserFLVHeader();
-    if (err) {
-        return errors_wrap(err, "parser flv header failed");
+template <typename Reader>
+error_t FLVParser::feedUnits(Reader* r, int64_t capacity) {
+    error_t err = errorsOK;
+
+    while (r->Remain() > 0) {
+        // enough bytes to know the unit size.
+        char head[15];
+        int64_t n = min(r->Remain(), (int64_t)sizeof(head));
+        int need = unitSize(r->Peek(n, head), n);
+        if (need > r->Remain()) {
+            if (capacity >= 0 && need > capacity) {
+                return failed(errors_new(-1, "unit %d exceeds the capacity %" PRId64, need, capacity));
+            }
+            break;
+        }
+
+        // in place, unless split by the wrap point or a chunk boundary.
+        const char* unit = NULL;
+        const shared_ptr<string>* block = NULL;
+        if (r->ContiguousRemain() >= need) {
+            // never gathered, the scratch is unused.
+            unit = r->Peek(need, head);
+        } else {
+            string* buf = carryBuffer();
+            buf->resize(need);
+            unit = r->Peek(need, &(*buf)[0]);
+            block = &carry;
+        }
+
+        err = parseUnit(unit, need, block);
+        r->Skip(need);
+        if (block) {
+            carryBuffer()->clear();
+        }
+        if (err != errorsOK) {
+            return errors_wrap(err, "parse unit at %" PRId64, r->Offset() - need);
+        }
     }
 
-    cout << header.toString() << endl;
+    return err;
+}
+
+error_t FLVParser::Feed(RingReader* ring) {
+    return feedUnits(ring, ring->Capacity());
+}
 
-    // parse flv body.
-    int previous_tag_len;
-    while (sb->Remain() > 4) {
-        previous_tag_len = sb->Read4Bytes();
-        cout << "previous tag len=" << previous_tag_len << endl;
-        parserFLVTagHeader();
-        cout << tag_header.toString() << endl;
-        
-        switch (tag_header.tag_type)
-        {
-        case TAG_TYPE_VIDEO:
-            /* code */
-            parseFLVVideoTag();
-            cout << video_tag.toString() << endl;
+error_t FLVParser::Feed(ChunkReader* chain) {
+    // the chain grows with the caller, no capacity.
+    return feedUnits(chain, -1);
+}
+
+// decode the 11 bytes tag header at p into r, except the offset.
+// unless header_only, the codec bytes of its data are decoded too and
+// the whole tag must be in the buffer.
+static void decode_tag_record(const char* p, FLVTagRecord* r, bool header_only)
+{
+    const uint8_t* u = (const uint8_t*)p;
+    uint8_t tag_type = u[0] & 0x1f;
+    uint32_t data_size = be_read24(p + 1);
+    const uint8_t* data = u + 11;
+
+    r->data_size = data_size;
+    r->timestamp = ((uint32_t)u[7] << 24) | be_read24(p + 4);
+    r->cts = 0;
+    r->flags = 0;
+    r->codec = 0;
+
+    switch (tag_type) {
+    case TAG_TYPE_VIDEO:
+        r->kind = TAG_KIND_VIDEO;
+        if (header_only) {
             break;
-        case TAG_TYPE_AUDIO: 
-            parseFLVAudioTag(); 
-            cout << audio_tag.toString() << endl;
+        }
+        if (data_size >= 1) {
+            r->codec = data[0] & 0x0f;
+            if ((data[0] >> 4) == 1) {
+                r->flags |= TAG_FLAG_KEYFRAME;
+            }
+        }
+        // avc packet type and SI24 composition time.
+        if (r->codec == 7 && data_size >= 5) {
+            if (data[1] == 0) {
+                r->flags |= TAG_FLAG_SEQUENCE_HEADER;
+            }
+            r->cts = ((int32_t)(be_read24((const char*)data + 2) << 8)) >> 8;
+        }
+        break;
+    case TAG_TYPE_AUDIO:
+        r->kind = TAG_KIND_AUDIO;
+        if (header_only) {
             break;
-        case TAG_TYPE_SCRIPT: 
-            parseFLVScriptTag();
+        }
+        if (data_size >= 1) {
+            r->codec = data[0] >> 4;
+        }
+        if (r->codec == AAC && data_size >= 2 && data[1] == 0) {
+            r->flags |= TAG_FLAG_SEQUENCE_HEADER;
+        }
+        break;
+    case TAG_TYPE_SCRIPT:
+        r->kind = TAG_KIND_SCRIPT;
+        break;
+    default:
+        r->kind = TAG_KIND_OTHER;
+        break;
+    }
+}
+
+error_t FLVParser::DecodeTagRecords(FLVTagRecord* records, int n, int* pcount) {
+    return decodeTagRecords(records, n, pcount, false);
+}
+
+error_t FLVParser::ScanTagRecords(FLVTagRecord* records, int n, int* pcount) {
+    return decodeTagRecords(records, n, pcount, true);
+}
+
+error_t FLVParser::decodeTagRecords(FLVTagRecord* records, int n, int* pcount, bool header_only) {
+    error_t err = errorsOK;
+    *pcount = 0;
+
+    if (!sb) {
+        return errors_new(-1, "decode requires a contiguous source");
+    }
+
+    if (!header_parsed) {
+        if ((err = parserFLVHeader()) != errorsOK) {
+            return failed(errors_wrap(err, "parser flv header failed"));
+        }
+        header_parsed = true;
+    }
+
+    int count = 0;
+    // PreviousTagSize(4) + tag header(11)
+    while (count < n && sb->require(15)) {
+        int64_t offset = sb->Offset() + 4;
+        const char* p = sb->ReadSlice(15) + 4;
+        uint32_t data_size = be_read24(p + 1);
+        if (!sb->require(data_size)) {
+            // truncated, leave it to the next call.
+            sb->Skip(-15);
             break;
-        default: break;
         }
-        cout << "----------------------" << endl;
+        sb->Skip(data_size);
+
+        // the next header is all a scan reads, warm it up while
+        // decoding this one.
+        if (header_only && sb->require(15)) {
+            __builtin_prefetch(p + 11 + data_size);
+        }
+
+        FLVTagRecord* r = &records[count++];
+        decode_tag_record(p, r, header_only);
+        r->offset = offset;
+    }
+
+    *pcount = count;
+    return err;
+}
+
+void FLVParser::SetIndex(FLVTagIndex* v) {
+    index = v;
+}
+
+error_t FLVParser::SeekToTime(uint32_t ms, int64_t* poffset) {
+    error_t err = errorsOK;
+    *poffset = -1;
+
+    if (!sb) {
+        return errors_new(-1, "seek requires a contiguous source");
+    }
+    if (!index || index->KeyframeCount() <= 0) {
+        return errors_new(-1, "no keyframe index to seek %u", ms);
+    }
+
+    int i = index->FindKeyframe(ms);
+    if (i < 0) {
+        i = 0;
+    }
+    int64_t offset = index->KeyframeOffsets()[i];
+
+    if ((err = SeekTo(offset)) != errorsOK) {
+        return errors_wrap(err, "seek to %u", ms);
     }
 
+    *poffset = offset;
     return err;
 }
 
-string FLVParser::FLVHeader::toString() {
-    stringstream ss;
-    ss << "version: " << to_string(version) << LF
-       << "type_flags_audio: " << to_string(type_flags_audio) << LF
-       << "type_flags_video: " << to_string(type_flags_video) << LF
-       << "data_offset: " << data_offset << LF;
-    return ss.str();
+error_t FLVParser::SeekTo(int64_t offset) {
+    error_t err = errorsOK;
+
+    // a push mode parser has no buffer to seek in.
+    if (!sb) {
+        return errors_new(-1, "seek requires a contiguous source");
+    }
+
+    if (!header_parsed) {
+        if ((err = parserFLVHeader()) != errorsOK) {
+            return failed(errors_wrap(err, "parser flv header failed"));
+        }
+        header_parsed = true;
+    }
+
+    // the parse loop starts at the PreviousTagSize in front of the tag.
+    int64_t pos = offset - 4;
+    if (pos < (int64_t)header.data_offset || pos > sb->Offset() + sb->Remain()) {
+        return errors_new(-1, "seek %" PRId64 " out of range", offset);
+    }
+    sb->Skip(pos - sb->Offset());
+
+    return err;
+}
+
+bool FLVParser::NextTag(FLVTagRecord* record, FLVPayload* payload) {
+    error_t err = errorsOK;
+
+    // a push mode parser has no buffer to iterate.
+    if (!sb) {
+        return false;
+    }
+
+    if (!header_parsed) {
+        if ((err = parserFLVHeader()) != errorsOK) {
+            // not the end of the stream, tell the visitor.
+            report(errors_wrap(err, "parser flv header failed"));
+            return false;
+        }
+        header_parsed = true;
+    }
+
+    // PreviousTagSize(4) + tag header(11)
+    if (!sb->require(15)) {
+        return false;
+    }
+    int64_t offset = sb->Offset() + 4;
+    const char* p = sb->ReadSlice(15) + 4;
+    uint32_t data_size = be_read24(p + 1);
+    if (!sb->require(data_size)) {
+        sb->Skip(-15);
+        return false;
+    }
+
+    payload->size = data_size;
+    payload->data = sb->ReadSlice(data_size);
+    payload->block = NULL;
+    payload->stable = unit_stable;
+    decode_tag_record(p, record, false);
+    record->offset = offset;
+
+    return true;
 }
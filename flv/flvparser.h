@@ -2,305 +2,156 @@
 #pragma once
 
 #include "common.h"
+#include "flvtag.h"
+#include "aac.h"
+#include "avc.h"
+#include "flvvisitor.h"
+#include "chunkchain.h"
+#include "ringbuffer.h"
 
-typedef enum SoundFormatE { 
-    LinearPCMPlatformEndian = 0,
-    ADPCM,
-    MP3,
-    LinearPCMLittleEndian,
-    Nellymoser16KHZMono,
-    Nellymoser8KHZMono,
-    Nellymoser,
-    G711ALawLogarithmicPCM,
-    G711muLawLogarithmicPCM,
-    reserved,
-    AAC,
-    Speex,
-    MP38KHZ,
-    DeviceSpecificSound,
-} SoundFormatE;
-
-/**
- * the aac object type, for RTMP sequence header
- * for AudioSpecificConfig, @see ISO_IEC_14496-3-AAC-2001.pdf, page 33
- * for audioObjectType, @see ISO_IEC_14496-3-AAC-2001.pdf, page 23
- */
-typedef enum AacObjectType
-{
-    AacObjectTypeReserved = 0,
-    AacObjectTypeForbidden = 0,
-    
-    // Table 1.1 - Audio Object Type definition
-    // @see @see ISO_IEC_14496-3-AAC-2001.pdf, page 23
-    AacObjectTypeAacMain = 1,
-    AacObjectTypeAacLC = 2,
-    AacObjectTypeAacSSR = 3,
-    
-    // AAC HE = LC+SBR
-    AacObjectTypeAacHE = 5,
-    // AAC HEv2 = LC+SBR+PS
-    AacObjectTypeAacHEV2 = 29,
-}AacObjectType;
-
-typedef enum AacSampleRateIndex{
-    SampleRate96000 = 0x0,
-    SampleRate88200 = 0x1,
-    SampleRate64000 = 0x2,
-    SampleRate48000 = 0x3,
-    SampleRate44100 = 0x4,
-    SampleRate32000 = 0x5,
-    SampleRate24000 = 0x6,
-    SampleRate22050 = 0x7,
-    SampleRate16000 = 0x8,
-    SampleRate12000 = 0x9,
-    SampleRate11025 = 0xa,
-    SampleRate8000 = 0xb,
-    SampleRate7350 = 0xc,
-    SampleRatereserved_0xd = 0xd,
-    SampleRatereserved_0xe = 0xe,
-    SampleRateEscapeValue_0xf = 0xf,
-}AacSampleRateIndex;
-
-
-
+class FLVTagIndex;
 
 class FLVParser
 {
 private:
-    const int minByteRequired = 12;
-    StreamBuf* sb;
+    // size of the flv header, without the first PreviousTagSize.
+    const int minByteRequired = 9;
+    // the biggest data_offset accepted, the header and a few KB of
+    // extension, a push mode parser buffers the whole header.
+    const int maxDataOffset = 9 + 4096;
+    // the concrete reader, resolved statically in the tag loops.
+    ContiguousReader* sb;
+    // push mode, whether the flv header has been consumed.
+    bool header_parsed;
+    // push mode, the head of a tag split across Feed() calls,
+    // at most one tag is kept, the capacity is reused unless a payload
+    // in it is pinned.
+    shared_ptr<string> carry;
+    // the owner of the bytes being parsed, see FLVPayload.
+    const shared_ptr<string>* unit_block;
+    bool unit_stable;
+    // receives the parsed tags, not owned.
+    FLVVisitor* visitor;
+    // the keyframe index for SeekToTime(), not owned.
+    FLVTagIndex* index;
 private:
-    typedef struct FLVHeader{
-        uint8_t signature[3]; // FLV
-        uint8_t version; // File version(for example, 0x01 for flv version 1)
-        uint8_t type_flags_reserved_5bit : 5; // Must be 0
-        uint8_t type_flags_audio : 1; // audio tags are present
-        uint8_t type_flags_reserved_1bit : 1; // must be 0
-        uint8_t type_flags_video : 1; // video tags are present
-        uint32_t data_offset;   // offset in bytes from start of file to start of body(that is, size of header)
-        public : 
-            string toString();
-    } FLVHeader;
     FLVHeader header;
-
-public:
-    uint32_t previous_tag_size;
-    typedef enum TagTypeE { 
-        TAG_TYPE_AUDIO = 8, 
-        TAG_TYPE_VIDEO = 9,
-        TAG_TYPE_SCRIPT = 18,
-        // all others: reserved
-    }TagTypeE;
-
-    typedef struct FLVTagHeader {
-        // type of this tag, values are:
-        // 8: audio
-        // 9: video
-        // 18: script data 
-        // all others: reserved 
-        unordered_map<TagTypeE, string> tag_type_mp={
-            {TAG_TYPE_AUDIO, "audio"},
-            {TAG_TYPE_VIDEO, "video"},
-            {TAG_TYPE_SCRIPT, "script"},
-        };
-        TagTypeE tag_type:8;
-        // length of the data in data field
-        uint32_t data_size : 24;
-        // time in milliseconds at which the data in this tag applies.
-        // this value is relative to the first tag in the flv file, 
-        // which always has a timestamp of 0.
-        uint32_t timestamp : 24;
-        // extension of timestamp field to form a SI32 value. 
-        // this field represents the upper 8bits, 
-        // while the previous Timestamp field represents the lower 24 bits 
-        // of the time in milliseconds.
-        uint8_t timestamp_extended;
-        uint32_t stream_id : 24; // always 0
-        // data...
-        public:
-            uint32_t Timestamp();
-            string toString();
-    } FLVTagHeader;
     FLVTagHeader tag_header;
-
-    typedef struct FLVTagAudio{
-        unordered_map<SoundFormatE, string> sound_format_mp={
-            {LinearPCMPlatformEndian, "LinearPCMPlatformEndian"},
-            {ADPCM, "ADPCM"},
-            {MP3, "MP3"},
-            {LinearPCMLittleEndian,"LinearPCMLittleEndian"},
-            {Nellymoser16KHZMono, "Nellymoser16KHZMono"},
-            {Nellymoser8KHZMono, "Nellymoser8KHZMono"},
-            {Nellymoser,"Nellymoser"},
-            {G711ALawLogarithmicPCM, "G711ALawLogarithmicPCM"},
-            {G711muLawLogarithmicPCM, "G711muLawLogarithmicPCM"},
-            {reserved, "reserved"},
-            {AAC, "AAC"},
-            {Speex,"Speex"},
-            {MP38KHZ,"MP38KHZ"},
-            {DeviceSpecificSound, "DeviceSpecificSound"},
-        };
-        SoundFormatE sound_format : 4;
-        // 0=5.5khz, 1=11khz, 2=22khz, 3=44khz
-        unordered_map<uint8_t, string> sound_rate_mp={
-            {0, "5.5KHz"},
-            {1, "11KHz"},
-            {2, "22KHz"},
-            {3, "44KHz"},
-        };
-        uint8_t sound_rate : 2;
-        // Size of each sample. This parameter only pertains to uncompressed formats.
-        // Compressed formats always decode to 16 bits internally. 
-        // 0 = snd8Bit 1 = snd16Bit
-        unordered_map<uint8_t, string> sound_size_mp={
-            {0, "snd8Bit"},
-            {1, "snd16Bit"},
-        };
-        uint8_t sound_size : 1;
-        // mono or stereo sound.
-        // for nellymoser: always 0
-        // for aac: always 1
-        unordered_map<uint8_t, string> sound_type_mp={
-            {0, "sndMono"},
-            {1, "sndStereo"},
-        };
-        uint8_t sound_type : 1;
-        // if sound_format == 10, the following values are defined:
-        // 0=aac sequence header
-        // 1=aac raw
-        unordered_map<uint8_t, string> aac_packet_type_mp = {
-            {0, "aac sequence header"},
-            {1, "aac raw"},
-        };
-        uint8_t aac_packet_type;
-        // @see 1.6.2.1 AudioSpecificConfig ISO_IEC_14496-3-AAC-2001
-        // https://ossrs.net/lts/zh-cn/assets/files/ISO_IEC_14496-3-AAC-2001-7f4d0b3622b322cb72c78f85d91c449f.pdf
-        unordered_map<AacObjectType, string> aac_object_mp={
-            // {AacObjectTypeReserved, "AacObjectTypeReserved"},
-            {AacObjectTypeForbidden, "AacObjectTypeForbidden"},
-            
-            // Table 1.1 - Audio Object Type definition
-            // @see @see ISO_IEC_14496-3-AAC-2001.pdf, page 23
-            {AacObjectTypeAacMain, "AacObjectTypeAacMain"},
-            {AacObjectTypeAacLC, "AacObjectTypeAacLC"},
-            {AacObjectTypeAacSSR, "AacObjectTypeAacSSR"},
-            
-            // AAC HE = LC+SBR
-            {AacObjectTypeAacHE, "AacObjectTypeAacHE"},
-            // AAC HEv2 = LC+SBR+PS
-            {AacObjectTypeAacHEV2, "AacObjectTypeAacHEV2"},
-        };
-        AacObjectType aac_object; // 5bit
-        // @see 1.6.3.3 samplingFrequencyIndex
-        unordered_map<AacSampleRateIndex, string> aac_sample_rate_mp = {
-            {SampleRate96000, "SampleRate96000"},
-            {SampleRate88200, "SampleRate88200"},
-            {SampleRate64000, "SampleRate88200"},
-            {SampleRate48000, "SampleRate48000"},
-            {SampleRate44100, "SampleRate44100"},
-            {SampleRate32000, "SampleRate32000"},
-            {SampleRate24000, "SampleRate24000"},
-            {SampleRate22050, "SampleRate22050"},
-            {SampleRate16000, "SampleRate16000"},
-            {SampleRate12000, "SampleRate12000"},
-            {SampleRate11025, "SampleRate11025"},
-            {SampleRate8000, "SampleRate8000"},
-            {SampleRate7350, "SampleRate7350"},
-            {SampleRatereserved_0xd, "SampleRatereserved_0xd"},
-            {SampleRatereserved_0xe, "SampleRatereserved_0xe"},
-            {SampleRateEscapeValue_0xf, "SampleRateEscapeValue_0xf"},
-        };
-        AacSampleRateIndex aac_sample_rate; // 4bit
-        // @see 1.6.3.4 channelConfiguration
-        uint8_t aac_channels; // 4bit
-        // sound data...
-        string toString();
-    } FLVTagAudio;
     FLVTagAudio audio_tag;
-    
-    typedef struct FLVTagVideo {
-        // 1: keyframe(for avc, a seekable frame)
-        // 2 inter frame(for avc, a non-seekable frame)
-        // 3: disposable inter frame(H263 only)
-        // 4: generated key frame(reserved for server use only)
-        // 5: video info/command frame
-        // if frame_type=5, instead of a video payload, the message
-        // stream contains a UI8 with the following meaning:
-        // 0=start of client-side seeking video frame sequence
-        // 1=end of client-side seeking video frame sequence
-        map<uint8_t, string> frame_type_mp={
-            {1, "keyframe(for avc, a seekable frame)"},
-            {2, "inter frame(for avc, a non-seekable frame)"},
-            {3, "disposable inter frame(H263 only)"},
-            {4, "generated key frame(reserved for server use only)"},
-            {5, "video info/command frame"},
-        };
-        uint8_t frame_type : 4;
-        // 1: jpeg(currently unused)
-        // 2: sorenson H263
-        // 3: screen video
-        // 4: on2 VP6
-        // 5: on2 vp6 with alpha channel
-        // 6: screen video version 2
-        // 7: avc
-        map<uint8_t, string> codec_id_mp={
-            {1, "jpeg(currently unused)"},
-            {2, "sorenson H263"},
-            {3, "screen video"},
-            {4, "on2 VP6"},
-            {5, "on2 vp6 with alpha channel"},
-            {6, "screen video version 2"},
-            {7, "avc"},
-        };
-        uint8_t codec_id : 4;
-        // if codec id == 7, the following values are defined: 
-        // 0 = avc sequence header
-        // 1 = avc nalu
-        // 2 = avc end of sequence(lowwer level nalu sequence ender is not required or supported)
-        map<uint8_t, string> avc_packet_type_mp={
-            {0,"avc sequence header"},
-            {1, "avc nalu"},
-            {2, "avc end of sequence"},
-        };
-        uint8_t avc_packet_type;
-        // if codec id == 7, if avc packet type ==1, composition time offset
-        // else 0
-        uint32_t composition_time:24;
-        // video data...
-        string toString();
-    } FLVTagVideo;
     FLVTagVideo video_tag;
-    
-
-    typedef struct AVCVideoPacket {
-        // 0: avc sequence header
-        // 1: avc nalu
-        // 2: avc end of sequence(lower level nalu 
-        //    sequence ender is not required or supported)
-        uint8_t avc_packet_type;
-        // if avc_packet_type == 1, composition time offset
-        // else 0
-        uint32_t composition_time : 24;
-        // if AVCPacketType == 0 
-        //      AVCDecoderConfigurationRecord 
-        // else if AVCPacketType == 1 
-        //      One or more NALUs (can be individual slices per FLV packets; 
-        //      that is, full frames are not strictly required) 
-        // else if AVCPacketType == 2 
-        //      Empty
-        // data...
-    } AVCVideoPacket;
+    // the AudioSpecificConfig of the stream, decoded once per change.
+    AacConfigCache aac_config;
+    // the AVCDecoderConfigurationRecord of the stream, decoded once per change.
+    AvcConfigCache avc_config;
 
 private:
     error_t parserFLVHeader();
+    // PreviousTagSize and the tag header.
     error_t parserFLVTagHeader();
-    error_t parseFLVVideoTag();
-    error_t parseFLVAudioTag();
-    error_t parseFLVScriptTag();
+    error_t parseFLVVideoTag(UncheckedCursor& c);
+    error_t parseFLVAudioTag(UncheckedCursor& c);
+    error_t parseFLVScriptTag(UncheckedCursor& c);
+    error_t parseFLVTag();
+    error_t failed(error_t err);
+    // a recoverable error, given to the visitor then freed, parsing goes on.
+    void report(error_t err);
+private:
+    // push mode, bytes of the unit(flv header, or PreviousTagSize + tag)
+    // starting at p, or the bytes required to know it when n is too small.
+    int unitSize(const char* p, int64_t n);
+    error_t parseUnit(const char* p, int len, const shared_ptr<string>* block);
+    // parse the complete units of a ring or chunk reader, in place when
+    // contiguous, capacity is the most bytes the reader holds, or -1.
+    template <typename Reader>
+    error_t feedUnits(Reader* r, int64_t capacity);
+    // the carry-over buffer to write, a new one when the last is pinned.
+    string* carryBuffer();
+    // the view of the rest of the tag data.
+    void viewPayload(UncheckedCursor& c, FLVPayload* payload);
+    error_t decodeTagRecords(FLVTagRecord* records, int n, int* pcount, bool header_only);
 
 public:
-    FLVParser(char*&& buf, int len);
+    FLVParser(char*&& buf, int64_t len);
+    // push mode, bytes are given by Feed().
+    FLVParser();
     ~FLVParser();
 public:
+    /**
+     * set the visitor which receives the header and tags,
+     * NULL to parse without any output.
+     */
+    void SetVisitor(FLVVisitor* v);
+    /**
+     * parse the whole buffer, an error for a push mode parser.
+     */
     errors* Parse();
+    /**
+     * push mode, feed the next bytes of a flv stream.
+     * every complete tag is parsed immediately from data, only a tag
+     * split across calls is copied to the carry-over buffer, so the
+     * memory is bounded by the biggest tag.
+     * payloads are views into data or the carry-over buffer, a visitor
+     * keeps one past the callback by FLVPayload::Pin().
+     */
+    error_t Feed(const char* data, int64_t size);
+    /**
+     * push mode, parse the complete units in the ring and consume them,
+     * an incomplete tag stays in the ring for the next call. a tag across
+     * the wrap point is gathered to the carry-over buffer, so the memory
+     * is the ring plus the biggest tag, never reallocated or moved.
+     * @remark the ring must hold the biggest tag, don't mix with
+     *       Feed(data, size) on the same parser.
+     */
+    error_t Feed(RingReader* ring);
+    /**
+     * push mode, parse the complete units in the chain of received chunks
+     * and consume them, like Feed(ring). a tag in one chunk is parsed in
+     * place, only a tag across chunks is gathered.
+     */
+    error_t Feed(ChunkReader* chain);
+    /**
+     * decode the headers of up to n consecutive tags from the current
+     * position into the caller's records, the flv header is consumed first
+     * if needed. only the tag header and the codec bytes of the data are
+     * read, the visitor is not called for tags.
+     * @param pcount, output the number of records decoded, 0 at the end
+     *       of the buffer or when the next tag is truncated.
+     * @remark an error for a push mode parser.
+     */
+    error_t DecodeTagRecords(FLVTagRecord* records, int n, int* pcount);
+    /**
+     * header-only scan, like DecodeTagRecords() but only the PreviousTagSize
+     * and the 11 bytes tag header are read, the next offset is computed
+     * from the DataSize and the payload pages are never touched. codec,
+     * flags and cts of the records are 0.
+     * @remark for a mmapped file, MADV_RANDOM avoids reading ahead the
+     *       payload between the headers.
+     */
+    error_t ScanTagRecords(FLVTagRecord* records, int n, int* pcount);
+public:
+    /**
+     * set the index used by SeekToTime(), NULL to disable seeking by time.
+     */
+    void SetIndex(FLVTagIndex* v);
+    /**
+     * seek to the nearest video keyframe at or before ms, or the first
+     * keyframe when all are after ms, by a binary search of the keyframe
+     * table of the index. Parse(), NextTag() and DecodeTagRecords()
+     * resume from the keyframe.
+     * @param poffset, output the offset of the keyframe tag header, -1 on error.
+     */
+    error_t SeekToTime(uint32_t ms, int64_t* poffset);
+    /**
+     * seek to the tag header at offset, the flv header is consumed first if needed.
+     * @remark an error for a push mode parser, which has no buffer to seek in.
+     */
+    error_t SeekTo(int64_t offset);
+    /**
+     * iterator, read the tag at the current position and move to the next.
+     * @param payload, output the view of the whole tag data.
+     * @return false at the end, when the tag is truncated, or for a push
+     *       mode parser. a broken flv header is given to the visitor by
+     *       onError().
+     */
+    bool NextTag(FLVTagRecord* record, FLVPayload* payload);
 };
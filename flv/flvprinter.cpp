@@ -0,0 +1,245 @@
+#include "flvprinter.h"
+#include "avc.h"
+
+static const char* tag_type_name(uint8_t v)
+{
+    switch (v) {
+        case TAG_TYPE_AUDIO: return "audio";
+        case TAG_TYPE_VIDEO: return "video";
+        case TAG_TYPE_SCRIPT: return "script";
+        default: return "";
+    }
+}
+
+static const char* sound_format_name(uint8_t v)
+{
+    static const char* names[] = {
+        "LinearPCMPlatformEndian", "ADPCM", "MP3", "LinearPCMLittleEndian",
+        "Nellymoser16KHZMono", "Nellymoser8KHZMono", "Nellymoser",
+        "G711ALawLogarithmicPCM", "G711muLawLogarithmicPCM", "reserved",
+        "AAC", "Speex", "MP38KHZ", "DeviceSpecificSound",
+    };
+    return v < sizeof(names) / sizeof(names[0]) ? names[v] : "";
+}
+
+static const char* sound_rate_name(uint8_t v)
+{
+    // 0=5.5khz, 1=11khz, 2=22khz, 3=44khz
+    static const char* names[] = {"5.5KHz", "11KHz", "22KHz", "44KHz"};
+    return names[v & 0x03];
+}
+
+static const char* sound_size_name(uint8_t v)
+{
+    return v ? "snd16Bit" : "snd8Bit";
+}
+
+static const char* sound_type_name(uint8_t v)
+{
+    return v ? "sndStereo" : "sndMono";
+}
+
+static const char* aac_packet_type_name(uint8_t v)
+{
+    switch (v) {
+        case 0: return "aac sequence header";
+        case 1: return "aac raw";
+        default: return "";
+    }
+}
+
+static const char* aac_object_name(uint8_t v)
+{
+    // @see ISO_IEC_14496-3-AAC-2001.pdf, page 23, Table 1.1
+    switch (v) {
+        case AacObjectTypeForbidden: return "AacObjectTypeForbidden";
+        case AacObjectTypeAacMain: return "AacObjectTypeAacMain";
+        case AacObjectTypeAacLC: return "AacObjectTypeAacLC";
+        case AacObjectTypeAacSSR: return "AacObjectTypeAacSSR";
+        case AacObjectTypeAacHE: return "AacObjectTypeAacHE";
+        case AacObjectTypeAacHEV2: return "AacObjectTypeAacHEV2";
+        default: return "";
+    }
+}
+
+static const char* aac_sample_rate_name(uint8_t v)
+{
+    // @see 1.6.3.3 samplingFrequencyIndex
+    static const char* names[] = {
+        "SampleRate96000", "SampleRate88200", "SampleRate64000", "SampleRate48000",
+        "SampleRate44100", "SampleRate32000", "SampleRate24000", "SampleRate22050",
+        "SampleRate16000", "SampleRate12000", "SampleRate11025", "SampleRate8000",
+        "SampleRate7350", "SampleRatereserved_0xd", "SampleRatereserved_0xe", "SampleRateEscapeValue_0xf",
+    };
+    return names[v & 0x0f];
+}
+
+static const char* frame_type_name(uint8_t v)
+{
+    switch (v) {
+        case 1: return "keyframe(for avc, a seekable frame)";
+        case 2: return "inter frame(for avc, a non-seekable frame)";
+        case 3: return "disposable inter frame(H263 only)";
+        case 4: return "generated key frame(reserved for server use only)";
+        case 5: return "video info/command frame";
+        default: return "";
+    }
+}
+
+static const char* codec_id_name(uint8_t v)
+{
+    switch (v) {
+        case 1: return "jpeg(currently unused)";
+        case 2: return "sorenson H263";
+        case 3: return "screen video";
+        case 4: return "on2 VP6";
+        case 5: return "on2 vp6 with alpha channel";
+        case 6: return "screen video version 2";
+        case 7: return "avc";
+        default: return "";
+    }
+}
+
+static const char* avc_packet_type_name(uint8_t v)
+{
+    switch (v) {
+        case 0: return "avc sequence header";
+        case 1: return "avc nalu";
+        case 2: return "avc end of sequence";
+        default: return "";
+    }
+}
+
+FLVPrintVisitor::FLVPrintVisitor(ostream& out) : os(out)
+{
+}
+
+FLVPrintVisitor::~FLVPrintVisitor()
+{
+}
+
+error_t FLVPrintVisitor::onHeader(const FLVHeader& header)
+{
+    os << "version: " << to_string(header.version) << LF
+       << "type_flags_audio: " << to_string(header.type_flags_audio) << LF
+       << "type_flags_video: " << to_string(header.type_flags_video) << LF
+       << "data_offset: " << header.data_offset << LF << endl;
+    return errorsOK;
+}
+
+void FLVPrintVisitor::printTagHeader(const FLVTagHeader& tag)
+{
+    os << "previous tag len=" << tag.previous_tag_size << endl;
+    os << "flv tag header:\n "
+       << "tag_type: " << tag_type_name(tag.tag_type) << LF
+       << "data_size: " << to_string(tag.data_size) << LF
+       << "timestamp: " << to_string(tag.timestamp) << LF
+       << "timestamp_extended: " << to_string(tag.timestamp_extended) << LF
+       << "timestamp(): " << to_string(tag.Timestamp()) << LF
+       << "stream_id: " << to_string(tag.stream_id) << LF << endl;
+}
+
+error_t FLVPrintVisitor::onAudio(const FLVTagHeader& tag, const FLVTagAudio& audio, FLVPayload payload)
+{
+    printTagHeader(tag);
+
+    os << "audio tag header:" << LF 
+       << "format: " << sound_format_name(audio.sound_format) << LF
+       << "rate: " << sound_rate_name(audio.sound_rate) << LF
+       << "sound_size: " << sound_size_name(audio.sound_size) << LF
+       << "sound_type: " << sound_type_name(audio.sound_type) << LF;
+    if (audio.sound_format == AAC) {
+        os << "packet type: " << aac_packet_type_name(audio.aac_packet_type) << LF; 
+        // the aac_* fields are stale when the config failed to decode.
+        if (audio.aac_packet_type == 0 && audio.aac_config) {
+            os << "aac_packet_type: " << aac_object_name(audio.aac_object) << LF
+               << "aac_sample_rate:" << aac_sample_rate_name(audio.aac_sample_rate) << LF;
+            if (audio.aac_sample_rate == SampleRateEscapeValue_0xf) {
+                os << "aac_sample_frequency: " << to_string(audio.aac_sample_frequency) << LF;
+            }
+            os << "aac_channels: " << to_string(audio.aac_channels) << LF; 
+        }
+    }
+    os << endl << "----------------------" << endl;
+    return errorsOK;
+}
+
+error_t FLVPrintVisitor::onVideo(const FLVTagHeader& tag, const FLVTagVideo& video, FLVPayload payload)
+{
+    printTagHeader(tag);
+
+    os << "video tag header: " << LF
+       << "frame_type: " << frame_type_name(video.frame_type) << LF
+       << "codec id: " << codec_id_name(video.codec_id) << LF;
+    if (video.codec_id == 7) {
+        os << "avc_packet_type: " << avc_packet_type_name(video.avc_packet_type) << LF
+           << "composition_time" << to_string(video.composition_time) << LF;
+        const AvcConfig* avc = video.avc_config;
+        if (video.avc_packet_type == 0 && avc) {
+            os << "avc_profile: " << to_string(avc->profile) << LF
+               << "avc_level: " << to_string(avc->level) << LF
+               << "nalu_length_size: " << to_string(avc->nalu_length_size) << LF
+               << "width: " << to_string(avc->width) << LF
+               << "height: " << to_string(avc->height) << LF
+               << "fps: " << avc->Fps() << LF;
+        }
+    }
+    os << endl << "----------------------" << endl;
+    return errorsOK;
+}
+
+error_t FLVPrintVisitor::onScript(const FLVTagHeader& tag, FLVPayload payload)
+{
+    error_t err = errorsOK;
+
+    printTagHeader(tag);
+
+    shared_ptr<void> autoFree(nullptr, [&](void*) {
+        os << "----------------------" << endl;
+    });
+
+    if (payload.size <= 0) {
+        return err;
+    }
+
+    // the printer only reads the payload.
+    StreamBuf sb(const_cast<char*>(payload.data), payload.size);
+    while (!sb.empty()) {
+        Amf0Any* any;
+        if ((err = amf0_read_any(&sb, &any, &arena)) != errorsOK) {
+            return errors_wrap(err, "failed read amf0");
+        }
+        // dispatch by the marker, no RTTI.
+        if (any->marker == RTMP_AMF0_String) {
+            os << any->to_str() << endl;
+        } else if (any->marker == RTMP_AMF0_EcmaArray) {
+            Amf0EcmaArray* array = any->to_ecma_array();
+            for (int i = 0; i < array->count(); i++) {
+                os << "key at " << to_string(i) << " is " << array->key_at(i) << endl;
+                Amf0Any* value = array->value_at(i);
+                switch (value->marker) {
+                    case RTMP_AMF0_String:
+                        os << "value at " << to_string(i) << "is " << value->to_str() << endl;
+                        break;
+                    case RTMP_AMF0_Number:
+                        os << "value at " << to_string(i) << "is " << value->to_number() << endl;
+                        break;
+                    case RTMP_AMF0_Boolean:
+                        os << "value at " << to_string(i) << "is " << value->to_boolean() << endl;
+                        break;
+                    case RTMP_AMF0_Date:
+                        os << "value at " << to_string(i) << "is " << value->to_date() << endl;
+                        break;
+                    default:
+                        break;
+                }
+            }
+        } else {
+            // @todo other amf0 type.
+        }
+        amf0_freep(any);
+        arena.Reset();
+    }
+
+    return err;
+}
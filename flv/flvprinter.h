@@ -0,0 +1,27 @@
+#pragma once
+
+#include "common.h"
+#include "flvvisitor.h"
+#include "arena.h"
+
+/**
+ * the human readable dump of every tag, the default output of the
+ * flv-parser tool. slow by nature, embedders should use their own visitor.
+ */
+class FLVPrintVisitor : public FLVVisitor
+{
+private:
+    ostream& os;
+    // the amf0 values of a script tag, released at once after printed.
+    Arena arena;
+public:
+    FLVPrintVisitor(ostream& out = cout);
+    virtual ~FLVPrintVisitor();
+public:
+    virtual error_t onHeader(const FLVHeader& header);
+    virtual error_t onAudio(const FLVTagHeader& tag, const FLVTagAudio& audio, FLVPayload payload);
+    virtual error_t onVideo(const FLVTagHeader& tag, const FLVTagVideo& video, FLVPayload payload);
+    virtual error_t onScript(const FLVTagHeader& tag, FLVPayload payload);
+private:
+    void printTagHeader(const FLVTagHeader& tag);
+};
@@ -0,0 +1,52 @@
+#include "flvvisitor.h"
+
+FLVVisitor::FLVVisitor()
+{
+}
+
+FLVVisitor::~FLVVisitor()
+{
+}
+
+error_t FLVVisitor::onHeader(const FLVHeader& header)
+{
+    return errorsOK;
+}
+
+error_t FLVVisitor::onAudio(const FLVTagHeader& tag, const FLVTagAudio& audio, FLVPayload payload)
+{
+    return errorsOK;
+}
+
+error_t FLVVisitor::onVideo(const FLVTagHeader& tag, const FLVTagVideo& video, FLVPayload payload)
+{
+    return errorsOK;
+}
+
+error_t FLVVisitor::onScript(const FLVTagHeader& tag, FLVPayload payload)
+{
+    return errorsOK;
+}
+
+FLVPinnedPayload FLVPayload::Pin() const
+{
+    FLVPinnedPayload pin;
+    pin.data = data;
+    pin.size = size;
+
+    if (stable) {
+        return pin;
+    }
+    if (block) {
+        pin.block = *block;
+        return pin;
+    }
+
+    pin.block = make_shared<string>(data, size);
+    pin.data = pin.block->data();
+    return pin;
+}
+
+void FLVVisitor::onError(error_t err)
+{
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include "error.h"
+#include "flvtag.h"
+
+/**
+ * the payload kept by FLVPayload::Pin(), valid while the pin lives.
+ */
+typedef struct FLVPinnedPayload {
+    const char* data;
+    int size;
+    // holds data alive, empty when data is the buffer given to the parser.
+    shared_ptr<string> block;
+} FLVPinnedPayload;
+
+/**
+ * a non-owning view of bytes in the buffer being parsed.
+ * @remark only valid during the callback, Pin() it to keep it longer.
+ */
+typedef struct FLVPayload {
+    const char* data;
+    int size;
+    // push mode, the refcounted carry-over block holding data, or NULL.
+    const shared_ptr<string>* block;
+    // whether data lives as long as the buffer given to the parser.
+    bool stable;
+public:
+    FLVPayload() : data(NULL), size(0), block(NULL), stable(false) {}
+    /**
+     * keep the bytes after the callback, without copying when possible:
+     * the parsed buffer is referenced, a carry-over block is refcounted,
+     * only the caller memory given to Feed() is copied.
+     */
+    FLVPinnedPayload Pin() const;
+} FLVPayload;
+
+/**
+ * receives the parsed flv header and tags from FLVParser.
+ * the descriptors are plain structs and the payloads are views into the
+ * parsed buffer, the parser never formats or allocates per tag.
+ * all callbacks do nothing by default, return an error to stop parsing.
+ */
+class FLVVisitor
+{
+public:
+    FLVVisitor();
+    virtual ~FLVVisitor();
+public:
+    virtual error_t onHeader(const FLVHeader& header);
+    /**
+     * @param payload, the sound data after the audio tag header,
+     *       for aac sequence header it's the AudioSpecificConfig.
+     */
+    virtual error_t onAudio(const FLVTagHeader& tag, const FLVTagAudio& audio, FLVPayload payload);
+    /**
+     * @param payload, the video data after the video tag header,
+     *       for avc it's the AVCDecoderConfigurationRecord or NALUs.
+     */
+    virtual error_t onVideo(const FLVTagHeader& tag, const FLVTagVideo& video, FLVPayload payload);
+    /**
+     * @param payload, the whole tag data, AMF0 encoded.
+     */
+    virtual error_t onScript(const FLVTagHeader& tag, FLVPayload payload);
+    /**
+     * called once when parsing fails, before the error is returned.
+     * also called for a broken codec sequence header, which is skipped and
+     * parsing goes on, the error is freed by the parser after the call.
+     * @remark the error is never freed here.
+     */
+    virtual void onError(error_t err);
+};
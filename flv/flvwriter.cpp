@@ -0,0 +1,68 @@
+#include "flvwriter.h"
+
+FLVWriter::FLVWriter(ByteBuffer* buf)
+{
+    out = buf;
+    tag_mark = -1;
+}
+
+FLVWriter::~FLVWriter()
+{
+}
+
+void FLVWriter::WriteHeader(bool has_audio, bool has_video)
+{
+    // signature(3) + version(1) + flags(1) + data_offset(4) + PreviousTagSize0(4)
+    out->Reserve(13);
+    out->WriteBytes("FLV", 3);
+    out->Write1Bytes(0x01);
+    out->Write1Bytes((has_audio ? 0x04 : 0) | (has_video ? 0x01 : 0));
+    out->Write4Bytes(9);
+    out->Write4Bytes(0);
+}
+
+void FLVWriter::BeginTag(TagTypeE type, uint32_t timestamp)
+{
+    assert(tag_mark < 0);
+    tag_mark = out->Mark();
+
+    out->Reserve(11);
+    out->Write1Bytes((uint8_t)type);
+    // DataSize, patched by EndTag().
+    out->Write3Bytes(0);
+    out->Write3Bytes(timestamp & 0xffffff);
+    out->Write1Bytes((uint8_t)(timestamp >> 24));
+    // StreamID, always 0.
+    out->Write3Bytes(0);
+}
+
+error_t FLVWriter::EndTag()
+{
+    assert(tag_mark >= 0);
+    int64_t tag_size = out->Mark() - tag_mark;
+    int64_t data_size = tag_size - 11;
+
+    if (data_size > 0xffffff) {
+        out->Truncate(tag_mark);
+        tag_mark = -1;
+        return errors_new(-1, "tag data %" PRId64 " bytes over 0xffffff", data_size);
+    }
+
+    out->Patch3Bytes(tag_mark + 1, (uint32_t)data_size);
+    out->Write4Bytes((uint32_t)tag_size);
+    tag_mark = -1;
+    return errorsOK;
+}
+
+error_t FLVWriter::WriteTag(TagTypeE type, uint32_t timestamp, const char* data, int size)
+{
+    out->Reserve(11 + size + 4);
+    BeginTag(type, timestamp);
+    out->WriteBytes(data, size);
+    return EndTag();
+}
+
+ByteBuffer* FLVWriter::Buffer()
+{
+    return out;
+}
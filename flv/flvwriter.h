@@ -0,0 +1,44 @@
+#pragma once
+
+#include "common.h"
+#include "flvtag.h"
+
+/**
+ * the flv muxer over a growable ByteBuffer.
+ * a tag is opened by BeginTag(), its data appended to Buffer() by any
+ * writer, e.g. amf0_write_any() for script data, and EndTag() patches
+ * the DataSize and appends the PreviousTagSize, so no size is computed
+ * before the data is written.
+ */
+class FLVWriter
+{
+private:
+    // the output, not owned.
+    ByteBuffer* out;
+    // the start of the open tag, -1 if none.
+    int64_t tag_mark;
+public:
+    FLVWriter(ByteBuffer* buf);
+    ~FLVWriter();
+public:
+    /**
+     * the flv header and the first PreviousTagSize.
+     */
+    void WriteHeader(bool has_audio, bool has_video);
+    /**
+     * open a tag, the DataSize is patched by EndTag().
+     */
+    void BeginTag(TagTypeE type, uint32_t timestamp);
+    /**
+     * close the open tag, the DataSize is 24 bits, a tag over 16 MiB is
+     * dropped from the buffer and an error returned.
+     */
+    error_t EndTag();
+    /**
+     * a whole tag whose data is already encoded, including the audio or
+     * video tag header bytes.
+     */
+    error_t WriteTag(TagTypeE type, uint32_t timestamp, const char* data, int size);
+public:
+    ByteBuffer* Buffer();
+};
@@ -1,30 +1,35 @@
 #include "common.h"
 #include "flvparser.h"
+#include "flvprinter.h"
+#include "mmapfile.h"
+#include <sys/mman.h>
 
-int main() {
+int main(int argc, char** argv) {
     const char* filePath = "../doc/source.200kbps.768x320.flv";
+    if (argc > 1) {
+        filePath = argv[1];
+    }
     cout << "hello flv parser" << endl;
 
-    ifstream ifs(filePath);
-	if(!ifs.is_open())
-	{
-		cerr << "ifstream open file error!\n";
-		return -1;
-	}
+    // map the file instead of reading it into heap, pages are faulted in
+    // only when the parser touches them.
+    MmapFile file;
+    if (file.Open(filePath) != errorsOK || file.Size() == 0) {
+        cerr << "mmap open file error!\n";
+        return -1;
+    }
+    // parse is a single linear pass.
+    file.Advise(MADV_SEQUENTIAL);
 
-    shared_ptr<void> autofree(nullptr, [&](void *) {
-        cout << "auto free file" << endl;
-        ifs.close();
-    });
-
-    ifs.seekg(0, ios_base::end); // 先把文件输入流指针定位到文档末尾来获取文档的长度
-    int length = ifs.tellg();
-	ifs.seekg(ios_base::beg);  //再将指针定位到文档开头来进行读取
-
-	char* buff = new char[length + 1](); //开辟一个buff
-    ifs.read(buff, length + 1); // 将内容读取到buff中
-    FLVParser parser(std::move(buff), length);
-    parser.Parse();
+    FLVPrintVisitor printer;
+    FLVParser parser(file.Data(), file.Size());
+    parser.SetVisitor(&printer);
+    error_t err = parser.Parse();
+    if (err != errorsOK) {
+        cerr << "parse error, " << errors::description(err) << endl;
+        errors_free(err);
+        return -1;
+    }
 
     return 0;
 }
@@ -0,0 +1,134 @@
+#include "test.h"
+#include "amfreader.h"
+#include "amfview.h"
+#include "arena.h"
+
+// counts the events of amf0_read_events().
+class CountHandler : public Amf0Handler
+{
+public:
+    int scalars;
+    int begins;
+    int ends;
+public:
+    CountHandler() : scalars(0), begins(0), ends(0) {}
+public:
+    virtual error_t on_number(std::string_view key, double value) { scalars++; return errorsOK; }
+    virtual error_t on_boolean(std::string_view key, bool value) { scalars++; return errorsOK; }
+    virtual error_t on_string(std::string_view key, std::string_view value) { scalars++; return errorsOK; }
+    virtual error_t on_date(std::string_view key, int64_t date, int16_t time_zone) { scalars++; return errorsOK; }
+    virtual error_t on_null(std::string_view key) { scalars++; return errorsOK; }
+    virtual error_t on_undefined(std::string_view key) { scalars++; return errorsOK; }
+    virtual error_t on_begin_object(std::string_view key) { begins++; return errorsOK; }
+    virtual error_t on_begin_ecma_array(std::string_view key, int32_t count) { begins++; return errorsOK; }
+    virtual error_t on_begin_strict_array(std::string_view key, int32_t count) { begins++; return errorsOK; }
+    virtual error_t on_end() { ends++; return errorsOK; }
+};
+
+// an object of every marker the writer supports, nested.
+static Amf0Object* make_value()
+{
+    Amf0Object* obj = Amf0Any::object();
+    obj->set("number", Amf0Any::number(3.5));
+    obj->set("boolean", Amf0Any::boolean(true));
+    obj->set("string", Amf0Any::str("flv"));
+    obj->set("empty", Amf0Any::str(""));
+    obj->set("null", Amf0Any::null());
+    obj->set("undefined", Amf0Any::undefined());
+    obj->set("date", Amf0Any::date(1700000000000LL));
+
+    Amf0EcmaArray* ecma = Amf0Any::ecma_array();
+    ecma->set("width", Amf0Any::number(1280));
+    ecma->set("height", Amf0Any::number(720));
+    obj->set("ecma", ecma);
+
+    Amf0StrictArray* arr = Amf0Any::strict_array();
+    arr->append(Amf0Any::number(1));
+    arr->append(Amf0Any::str("two"));
+    Amf0Object* inner = Amf0Any::object();
+    inner->set("deep", Amf0Any::boolean(false));
+    arr->append(inner);
+    obj->set("array", arr);
+    return obj;
+}
+
+int main(int argc, char** argv)
+{
+    Amf0Object* value = make_value();
+    ByteBuffer encoded;
+    EXPECT_OK(amf0_write_any(&encoded, value));
+    freep(value);
+
+    // read back and write again, the bytes are the same.
+    StreamBuf stream(encoded.Data(), encoded.Size());
+    Amf0Any* decoded = NULL;
+    EXPECT_OK(amf0_read_any(&stream, &decoded));
+    EXPECT(stream.empty());
+    EXPECT(decoded && decoded->is_object());
+    if (decoded && decoded->is_object()) {
+        Amf0Object* obj = decoded->to_object();
+        EXPECT(obj->count() == 9);
+        Amf0Any* prop = obj->get_property("number");
+        EXPECT(prop && prop->is_number() && prop->to_number() == 3.5);
+        prop = obj->get_property("string");
+        EXPECT(prop && prop->is_string() && prop->to_str() == "flv");
+        prop = obj->get_property("date");
+        EXPECT(prop && prop->is_date() && prop->to_date() == 1700000000000LL);
+        prop = obj->get_property("ecma");
+        EXPECT(prop && prop->is_ecma_array() && prop->to_ecma_array()->count() == 2);
+        prop = obj->get_property("array");
+        EXPECT(prop && prop->is_strict_array() && prop->to_strict_array()->count() == 3);
+
+        ByteBuffer again;
+        EXPECT_OK(amf0_write_any(&again, decoded));
+        EXPECT(again.Size() == encoded.Size() && !memcmp(again.Data(), encoded.Data(), encoded.Size()));
+    }
+    freep(decoded);
+
+    // decoded to an arena, the same bytes again.
+    Arena arena;
+    StreamBuf in_arena(encoded.Data(), encoded.Size());
+    EXPECT_OK(amf0_read_any(&in_arena, &decoded, &arena));
+    if (decoded) {
+        ByteBuffer again;
+        EXPECT_OK(amf0_write_any(&again, decoded));
+        EXPECT(again.Size() == encoded.Size() && !memcmp(again.Data(), encoded.Data(), encoded.Size()));
+        amf0_freep(decoded);
+    }
+    arena.Reset();
+
+    // the lazy view finds the values in place.
+    Amf0View view(encoded.Data(), encoded.Size());
+    int64_t extent = 0;
+    EXPECT_OK(amf0_extent(encoded.Data(), encoded.Size(), &extent));
+    EXPECT(extent == encoded.Size());
+    Amf0View prop;
+    EXPECT(view.get_property("string", &prop) && prop.to_str() == "flv");
+    Amf0View ecma;
+    EXPECT(view.get_property("ecma", &ecma) && ecma.get_property("height", &prop) && prop.to_number() == 720);
+    Amf0View arr;
+    EXPECT(view.get_property("array", &arr) && arr.at(1, &prop) && prop.to_str() == "two");
+
+    // the events, 12 scalars and 4 complex values in all.
+    StreamBuf events(encoded.Data(), encoded.Size());
+    CountHandler h;
+    EXPECT_OK(amf0_read_events(&events, &h));
+    EXPECT(h.scalars == 12 && h.begins == 4 && h.ends == 4);
+
+    // no truncation of the value is read past its end.
+    for (int64_t n = 1; n < encoded.Size(); n++) {
+        std::string cut(encoded.Data(), n);
+        StreamBuf s(&cut[0], n);
+        Amf0Any* any = NULL;
+        // an object may end without its object-eof, the decoder allows it.
+        error_t err = amf0_read_any(&s, &any);
+        EXPECT(err != errorsOK || any != NULL);
+        errors_free(err);
+        freep(any);
+        err = amf0_extent(cut.data(), n, &extent);
+        EXPECT(err != errorsOK || extent <= n);
+        errors_free(err);
+    }
+
+    return test_failures ? 1 : 0;
+}
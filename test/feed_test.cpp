@@ -0,0 +1,117 @@
+#include "test.h"
+#include "flvparser.h"
+
+// logs every callback, with the whole payload, to compare the modes.
+class RecordVisitor : public FLVVisitor
+{
+public:
+    std::string log;
+    int errors;
+public:
+    RecordVisitor() : errors(0) {}
+public:
+    virtual error_t onHeader(const FLVHeader& header) {
+        log += "header " + to_string(header.data_offset) + "\n";
+        return errorsOK;
+    }
+    virtual error_t onAudio(const FLVTagHeader& tag, const FLVTagAudio& audio, FLVPayload payload) {
+        log += "audio " + to_string(tag.Timestamp()) + " " + to_string(audio.aac_packet_type)
+            + " " + (audio.aac_config ? "config " : "") + std::string(payload.data, payload.size) + "\n";
+        return errorsOK;
+    }
+    virtual error_t onVideo(const FLVTagHeader& tag, const FLVTagVideo& video, FLVPayload payload) {
+        log += "video " + to_string(tag.Timestamp()) + " " + to_string(video.frame_type)
+            + " " + (video.avc_config ? "config " : "") + std::string(payload.data, payload.size) + "\n";
+        return errorsOK;
+    }
+    virtual error_t onScript(const FLVTagHeader& tag, FLVPayload payload) {
+        log += "script " + to_string(tag.Timestamp()) + " " + std::string(payload.data, payload.size) + "\n";
+        return errorsOK;
+    }
+    virtual void onError(error_t err) {
+        errors++;
+    }
+};
+
+static std::string parse_pull(ByteBuffer* flv)
+{
+    char* buf = flv->Data();
+    RecordVisitor v;
+    FLVParser p(std::move(buf), flv->Size());
+    p.SetVisitor(&v);
+    EXPECT_OK(p.Parse());
+    EXPECT(v.errors == 0);
+    return v.log;
+}
+
+static std::string feed_data(ByteBuffer* flv, int64_t chunk)
+{
+    RecordVisitor v;
+    FLVParser p;
+    p.SetVisitor(&v);
+    for (int64_t o = 0; o < flv->Size(); o += chunk) {
+        EXPECT_OK(p.Feed(flv->Data() + o, min(chunk, flv->Size() - o)));
+    }
+    EXPECT(v.errors == 0);
+    return v.log;
+}
+
+static std::string feed_ring(ByteBuffer* flv, int64_t chunk)
+{
+    RecordVisitor v;
+    FLVParser p;
+    p.SetVisitor(&v);
+    // holds the biggest tag, smaller than the stream so it wraps.
+    RingReader ring(128 * 1024);
+    for (int64_t o = 0; o < flv->Size();) {
+        o += ring.Write(flv->Data() + o, min(chunk, flv->Size() - o));
+        EXPECT_OK(p.Feed(&ring));
+    }
+    // only the last PreviousTagSize is left, no tag follows it.
+    EXPECT(ring.Remain() == 4);
+    EXPECT(v.errors == 0);
+    return v.log;
+}
+
+static std::string feed_chunks(ByteBuffer* flv, int64_t chunk)
+{
+    RecordVisitor v;
+    FLVParser p;
+    p.SetVisitor(&v);
+    ChunkReader chain;
+    for (int64_t o = 0; o < flv->Size(); o += chunk) {
+        chain.Append(flv->Data() + o, min(chunk, flv->Size() - o));
+        EXPECT_OK(p.Feed(&chain));
+    }
+    // only the last PreviousTagSize is left, no tag follows it.
+    EXPECT(chain.Remain() == 4);
+    EXPECT(v.errors == 0);
+    return v.log;
+}
+
+int main(int argc, char** argv)
+{
+    ByteBuffer flv;
+    test_make_flv(&flv);
+
+    std::string expect = parse_pull(&flv);
+    EXPECT(std::count(expect.begin(), expect.end(), '\n') > 80);
+
+    // push mode sees the same tags and payloads as pull mode, however the
+    // stream is split.
+    int64_t chunks[] = {1, 2, 3, 7, 9, 13, 15, 16, 64, 1000, 4096, 65536, flv.Size()};
+    for (int64_t chunk : chunks) {
+        EXPECT(feed_data(&flv, chunk) == expect);
+        EXPECT(feed_ring(&flv, chunk) == expect);
+        EXPECT(feed_chunks(&flv, chunk) == expect);
+    }
+
+    // a pull mode entry point of a push mode parser is an error.
+    FLVParser p;
+    EXPECT_ERROR(p.Parse());
+    FLVTagRecord r;
+    FLVPayload payload;
+    EXPECT(!p.NextTag(&r, &payload));
+
+    return test_failures ? 1 : 0;
+}
@@ -0,0 +1,65 @@
+#include "test.h"
+#include "flvindex.h"
+#include <unistd.h>
+
+int main(int argc, char** argv)
+{
+    ByteBuffer flv;
+    test_make_flv(&flv);
+
+    FLVTagIndex built;
+    char* buf = flv.Data();
+    FLVParser parser(std::move(buf), flv.Size());
+    EXPECT_OK(built.Build(&parser));
+    // onMetaData, two sequence headers, 40 audio and 40 video tags.
+    EXPECT(built.Count() == 83);
+    EXPECT(built.KeyframeCount() == 4);
+
+    // the key of a real file.
+    const char* path = "index_test.flv";
+    FILE* fp = fopen(path, "wb");
+    EXPECT(fp && fwrite(flv.Data(), 1, flv.Size(), fp) == (size_t)flv.Size());
+    if (fp) {
+        fclose(fp);
+    }
+    int64_t size = 0, mtime = 0;
+    EXPECT_OK(FLVTagIndex::FileKey(path, &size, &mtime));
+    EXPECT(size == flv.Size());
+
+    // save and map it back, the columns are the same.
+    string sidecar = FLVTagIndex::SidecarPath(path);
+    EXPECT(sidecar == "index_test.flv.idx");
+    EXPECT_OK(built.Save(sidecar.c_str(), size, mtime));
+
+    FLVTagIndex loaded;
+    EXPECT_OK(loaded.Load(sidecar.c_str(), size, mtime));
+    EXPECT(loaded.Count() == built.Count());
+    EXPECT(loaded.KeyframeCount() == built.KeyframeCount());
+    if (loaded.Count() == built.Count() && loaded.KeyframeCount() == built.KeyframeCount()) {
+        int n = built.Count();
+        int k = built.KeyframeCount();
+        EXPECT(!memcmp(loaded.Offsets(), built.Offsets(), n * sizeof(int64_t)));
+        EXPECT(!memcmp(loaded.Timestamps(), built.Timestamps(), n * sizeof(uint32_t)));
+        EXPECT(!memcmp(loaded.Sizes(), built.Sizes(), n * sizeof(uint32_t)));
+        EXPECT(!memcmp(loaded.Kinds(), built.Kinds(), n));
+        EXPECT(!memcmp(loaded.Flags(), built.Flags(), n));
+        EXPECT(!memcmp(loaded.KeyframeOffsets(), built.KeyframeOffsets(), k * sizeof(int64_t)));
+        EXPECT(!memcmp(loaded.KeyframeTimes(), built.KeyframeTimes(), k * sizeof(uint32_t)));
+        EXPECT(loaded.FindKeyframe(500) == built.FindKeyframe(500));
+    }
+
+    // a key of another size or mtime is stale, the index is empty then.
+    EXPECT_ERROR(loaded.Load(sidecar.c_str(), size + 1, mtime));
+    EXPECT(loaded.Count() == 0);
+    EXPECT_ERROR(loaded.Load(sidecar.c_str(), size, mtime + 1));
+    EXPECT(loaded.Count() == 0);
+
+    // a truncated sidecar is rejected.
+    EXPECT(truncate(sidecar.c_str(), 64 + 10) == 0);
+    EXPECT_ERROR(loaded.Load(sidecar.c_str(), size, mtime));
+    EXPECT(loaded.Count() == 0);
+
+    ::remove(sidecar.c_str());
+    ::remove(path);
+    return test_failures ? 1 : 0;
+}
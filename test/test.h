@@ -0,0 +1,78 @@
+#pragma once
+
+#include "common.h"
+#include "flvwriter.h"
+
+// the checks failed so far, a test returns non-zero when any failed.
+static int test_failures = 0;
+
+#define EXPECT(cond) \
+    if (!(cond)) { \
+        fprintf(stderr, "%s:%d: expect %s\n", __FILE__, __LINE__, #cond); \
+        test_failures++; \
+    } \
+    (void)0
+
+// check the error is errorsOK, else print and free it.
+#define EXPECT_OK(expr) \
+    do { \
+        error_t test_err = (expr); \
+        if (test_err != errorsOK) { \
+            fprintf(stderr, "%s:%d: %s failed, %s\n", __FILE__, __LINE__, #expr, errors::description(test_err).c_str()); \
+            errors_free(test_err); \
+            test_failures++; \
+        } \
+    } while (0)
+
+// check the expr fails, the error is freed.
+#define EXPECT_ERROR(expr) \
+    do { \
+        error_t test_err = (expr); \
+        EXPECT(test_err != errorsOK); \
+        errors_free(test_err); \
+    } while (0)
+
+/**
+ * a small flv of every kind of tag: onMetaData, aac and avc sequence
+ * headers, keyframes every 10 frames, and one tag bigger than 64 KiB, so
+ * tags split across any chunk size, ring wrap or chunk boundary.
+ */
+static inline void test_make_flv(ByteBuffer* out)
+{
+    FLVWriter w(out);
+    w.WriteHeader(true, true);
+
+    w.BeginTag(TAG_TYPE_SCRIPT, 0);
+    Amf0Any* name = Amf0Any::str("onMetaData");
+    amf0_write_any(out, name);
+    freep(name);
+    Amf0EcmaArray* meta = Amf0Any::ecma_array();
+    meta->set("duration", Amf0Any::number(4.0));
+    meta->set("encoder", Amf0Any::str("test"));
+    amf0_write_any(out, meta);
+    freep(meta);
+    w.EndTag();
+
+    // AAC LC, 44.1kHz, stereo.
+    const char ash[] = {(char)0xaf, 0x00, 0x12, 0x10};
+    w.WriteTag(TAG_TYPE_AUDIO, 0, ash, sizeof(ash));
+    // avc, a record of no parameter sets.
+    const char vsh[] = {0x17, 0x00, 0x00, 0x00, 0x00, 0x01, 0x64, 0x00, 0x1f, (char)0xff, (char)0xe0, 0x00};
+    w.WriteTag(TAG_TYPE_VIDEO, 0, vsh, sizeof(vsh));
+
+    std::string data;
+    for (int i = 0; i < 40; i++) {
+        uint32_t ts = i * 40;
+
+        data.assign(1 + (i * 37) % 300, (char)i);
+        data[0] = (char)0xaf;
+        data.insert(data.begin() + 1, 0x01);
+        w.WriteTag(TAG_TYPE_AUDIO, ts, data.data(), (int)data.size());
+
+        int size = i == 17 ? 70000 : 5 + (i * 131) % 2000;
+        data.assign(size, (char)(i * 3));
+        data[0] = i % 10 == 0 ? 0x17 : 0x27;
+        data[1] = 0x01;
+        w.WriteTag(TAG_TYPE_VIDEO, ts, data.data(), (int)data.size());
+    }
+}
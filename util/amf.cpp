@@ -1,45 +1,58 @@
 
 #include <amf.h>
+#include "byteorder.h"
+#include <algorithm>
+#include <new>
 #include <utility>
 #include <vector>
 #include <sstream>
 using namespace std;
 
-// AMF0 marker
-#define RTMP_AMF0_Number                     0x00
-#define RTMP_AMF0_Boolean                     0x01
-#define RTMP_AMF0_String                     0x02
-#define RTMP_AMF0_Object                     0x03
-#define RTMP_AMF0_MovieClip                 0x04 // reserved, not supported
-#define RTMP_AMF0_Null                         0x05
-#define RTMP_AMF0_Undefined                 0x06
-#define RTMP_AMF0_Reference                 0x07
-#define RTMP_AMF0_EcmaArray                 0x08
-#define RTMP_AMF0_ObjectEnd                 0x09
-#define RTMP_AMF0_StrictArray                 0x0A
-#define RTMP_AMF0_Date                         0x0B
-#define RTMP_AMF0_LongString                 0x0C
-#define RTMP_AMF0_UnSupported                 0x0D
-#define RTMP_AMF0_RecordSet                 0x0E // reserved, not supported
-#define RTMP_AMF0_XmlDocument                 0x0F
-#define RTMP_AMF0_TypedObject                 0x10
-// AVM+ object is the AMF3 object.
-#define RTMP_AMF0_AVMplusObject             0x11
-// origin array whos data takes the same form as LengthValueBytes
-#define RTMP_AMF0_OriginStrictArray         0x20
-
-// User defined
-#define RTMP_AMF0_Invalid                     0x3F
-
 Amf0Any::Amf0Any()
 {
     marker = RTMP_AMF0_Invalid;
+    _arena = NULL;
 }
 
 Amf0Any::~Amf0Any()
 {
 }
 
+void* Amf0Any::operator new(size_t size)
+{
+    return ::operator new(size);
+}
+
+void* Amf0Any::operator new(size_t size, Arena* arena)
+{
+    return arena->Alloc(size);
+}
+
+void Amf0Any::operator delete(void* p)
+{
+    ::operator delete(p);
+}
+
+void Amf0Any::operator delete(void* /*p*/, Arena* /*arena*/)
+{
+    // the constructor failed, the arena releases the memory by Reset().
+}
+
+void Amf0Any::destroy(Amf0Any* v)
+{
+    // in an arena only the destructor runs, the memory is released by Reset().
+    if (v->_arena) {
+        v->~Amf0Any();
+        return;
+    }
+    delete v;
+}
+
+Arena* Amf0Any::arena()
+{
+    return _arena;
+}
+
 bool Amf0Any::is_string()
 {
     return marker == RTMP_AMF0_String;
@@ -92,71 +105,101 @@ bool Amf0Any::is_complex_object()
 
 string Amf0Any::to_str()
 {
-    Amf0String* p = dynamic_cast<Amf0String*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_String);
+    Amf0String* p = static_cast<Amf0String*>(this);
     return p->value;
 }
 
 const char* Amf0Any::to_str_raw()
 {
-    Amf0String* p = dynamic_cast<Amf0String*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_String);
+    Amf0String* p = static_cast<Amf0String*>(this);
     return p->value.data();
 }
 
 bool Amf0Any::to_boolean()
 {
-    Amf0Boolean* p = dynamic_cast<Amf0Boolean*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_Boolean);
+    Amf0Boolean* p = static_cast<Amf0Boolean*>(this);
     return p->value;
 }
 
 double Amf0Any::to_number()
 {
-    Amf0Number* p = dynamic_cast<Amf0Number*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_Number);
+    Amf0Number* p = static_cast<Amf0Number*>(this);
     return p->value;
 }
 
 int64_t Amf0Any::to_date()
 {
-    Amf0Date* p = dynamic_cast<Amf0Date*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_Date);
+    Amf0Date* p = static_cast<Amf0Date*>(this);
     return p->date();
 }
 
 int16_t Amf0Any::to_date_time_zone()
 {
-    Amf0Date* p = dynamic_cast<Amf0Date*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_Date);
+    Amf0Date* p = static_cast<Amf0Date*>(this);
     return p->time_zone();
 }
 
 Amf0Object* Amf0Any::to_object()
 {
-    Amf0Object* p = dynamic_cast<Amf0Object*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_Object);
+    Amf0Object* p = static_cast<Amf0Object*>(this);
     return p;
 }
 
 Amf0EcmaArray* Amf0Any::to_ecma_array()
 {
-    Amf0EcmaArray* p = dynamic_cast<Amf0EcmaArray*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_EcmaArray);
+    Amf0EcmaArray* p = static_cast<Amf0EcmaArray*>(this);
     return p;
 }
 
 Amf0StrictArray* Amf0Any::to_strict_array()
 {
-    Amf0StrictArray* p = dynamic_cast<Amf0StrictArray*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_StrictArray);
+    Amf0StrictArray* p = static_cast<Amf0StrictArray*>(this);
     return p;
 }
 
+error_t Amf0Any::visit(Amf0Visitor* v)
+{
+    switch (marker) {
+        case RTMP_AMF0_String:
+            return v->on_string(static_cast<Amf0String*>(this)->value);
+        case RTMP_AMF0_Boolean:
+            return v->on_boolean(static_cast<Amf0Boolean*>(this)->value);
+        case RTMP_AMF0_Number:
+            return v->on_number(static_cast<Amf0Number*>(this)->value);
+        case RTMP_AMF0_Date: {
+            Amf0Date* p = static_cast<Amf0Date*>(this);
+            return v->on_date(p->date(), p->time_zone());
+        }
+        case RTMP_AMF0_Null:
+            return v->on_null();
+        case RTMP_AMF0_Undefined:
+            return v->on_undefined();
+        case RTMP_AMF0_Object:
+            return v->on_object(static_cast<Amf0Object*>(this));
+        case RTMP_AMF0_EcmaArray:
+            return v->on_ecma_array(static_cast<Amf0EcmaArray*>(this));
+        case RTMP_AMF0_StrictArray:
+            return v->on_strict_array(static_cast<Amf0StrictArray*>(this));
+        case RTMP_AMF0_ObjectEnd:
+            return v->on_object_eof();
+        default:
+            return errors_new(-1, "visit invalid marker=%#x", marker);
+    }
+}
+
 void Amf0Any::set_number(double value)
 {
-    Amf0Number* p = dynamic_cast<Amf0Number*>(this);
-    assert(p != NULL);
+    assert(marker == RTMP_AMF0_Number);
+    Amf0Number* p = static_cast<Amf0Number*>(this);
     p->value = value;
 }
 
@@ -305,70 +348,90 @@ char* Amf0Any::human_print(char** pdata, int* psize)
     
 // }
 
-Amf0Any* Amf0Any::str(const char* value)
+Amf0Any* Amf0Any::str(const char* value, Arena* arena)
 {
-    return new Amf0String(value);
+    Amf0String* v = arena? new (arena) Amf0String(value) : new Amf0String(value);
+    v->_arena = arena;
+    return v;
 }
 
-Amf0Any* Amf0Any::boolean(bool value)
+Amf0Any* Amf0Any::boolean(bool value, Arena* arena)
 {
-    return new Amf0Boolean(value);
+    Amf0Boolean* v = arena? new (arena) Amf0Boolean(value) : new Amf0Boolean(value);
+    v->_arena = arena;
+    return v;
 }
 
-Amf0Any* Amf0Any::number(double value)
+Amf0Any* Amf0Any::number(double value, Arena* arena)
 {
-    return new Amf0Number(value);
+    Amf0Number* v = arena? new (arena) Amf0Number(value) : new Amf0Number(value);
+    v->_arena = arena;
+    return v;
 }
 
-Amf0Any* Amf0Any::null()
+Amf0Any* Amf0Any::null(Arena* arena)
 {
-    return new Amf0Null();
+    Amf0Null* v = arena? new (arena) Amf0Null() : new Amf0Null();
+    v->_arena = arena;
+    return v;
 }
 
-Amf0Any* Amf0Any::undefined()
+Amf0Any* Amf0Any::undefined(Arena* arena)
 {
-    return new Amf0Undefined();
+    Amf0Undefined* v = arena? new (arena) Amf0Undefined() : new Amf0Undefined();
+    v->_arena = arena;
+    return v;
 }
 
-Amf0Object* Amf0Any::object()
+Amf0Object* Amf0Any::object(Arena* arena)
 {
-    return new Amf0Object();
+    Amf0Object* v = arena? new (arena) Amf0Object() : new Amf0Object();
+    v->_arena = arena;
+    return v;
 }
 
-Amf0Any* Amf0Any::object_eof()
+Amf0Any* Amf0Any::object_eof(Arena* arena)
 {
-    return new Amf0ObjectEOF();
+    Amf0ObjectEOF* v = arena? new (arena) Amf0ObjectEOF() : new Amf0ObjectEOF();
+    v->_arena = arena;
+    return v;
 }
 
-Amf0EcmaArray* Amf0Any::ecma_array()
+Amf0EcmaArray* Amf0Any::ecma_array(Arena* arena)
 {
-    return new Amf0EcmaArray();
+    Amf0EcmaArray* v = arena? new (arena) Amf0EcmaArray() : new Amf0EcmaArray();
+    v->_arena = arena;
+    return v;
 }
 
-Amf0StrictArray* Amf0Any::strict_array()
+Amf0StrictArray* Amf0Any::strict_array(Arena* arena)
 {
-    return new Amf0StrictArray();
+    Amf0StrictArray* v = arena? new (arena) Amf0StrictArray() : new Amf0StrictArray();
+    v->_arena = arena;
+    return v;
 }
 
-Amf0Any* Amf0Any::date(int64_t value)
+Amf0Any* Amf0Any::date(int64_t value, Arena* arena)
 {
-    return new Amf0Date(value);
+    Amf0Date* v = arena? new (arena) Amf0Date(value) : new Amf0Date(value);
+    v->_arena = arena;
+    return v;
 }
 
-error_t Amf0Any::discovery(StreamBuf* stream, Amf0Any** ppvalue)
+error_t Amf0Any::discovery(StreamBuf* stream, Amf0Any** ppvalue, Arena* arena)
 {
     error_t err = errorsOK;
     
     // detect the object-eof specially
     if (amf0_is_object_eof(stream)) {
-        *ppvalue = new Amf0ObjectEOF();
+        *ppvalue = Amf0Any::object_eof(arena);
         return err;
     }
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "marker requires 1 only %d bytes", stream->Remain());
-        // return srs_error_new(-1, "marker requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "marker requires 1 only %" PRId64 " bytes", stream->Remain());
+        // return srs_error_new(-1, "marker requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -378,39 +441,39 @@ error_t Amf0Any::discovery(StreamBuf* stream, Amf0Any** ppvalue)
     
     switch (marker) {
         case RTMP_AMF0_String: {
-            *ppvalue = Amf0Any::str();
+            *ppvalue = Amf0Any::str(NULL, arena);
             return err;
         }
         case RTMP_AMF0_Boolean: {
-            *ppvalue = Amf0Any::boolean();
+            *ppvalue = Amf0Any::boolean(false, arena);
             return err;
         }
         case RTMP_AMF0_Number: {
-            *ppvalue = Amf0Any::number();
+            *ppvalue = Amf0Any::number(0.0, arena);
             return err;
         }
         case RTMP_AMF0_Null: {
-            *ppvalue = Amf0Any::null();
+            *ppvalue = Amf0Any::null(arena);
             return err;
         }
         case RTMP_AMF0_Undefined: {
-            *ppvalue = Amf0Any::undefined();
+            *ppvalue = Amf0Any::undefined(arena);
             return err;
         }
         case RTMP_AMF0_Object: {
-            *ppvalue = Amf0Any::object();
+            *ppvalue = Amf0Any::object(arena);
             return err;
         }
         case RTMP_AMF0_EcmaArray: {
-            *ppvalue = Amf0Any::ecma_array();
+            *ppvalue = Amf0Any::ecma_array(arena);
             return err;
         }
         case RTMP_AMF0_StrictArray: {
-            *ppvalue = Amf0Any::strict_array();
+            *ppvalue = Amf0Any::strict_array(arena);
             return err;
         }
         case RTMP_AMF0_Date: {
-            *ppvalue = Amf0Any::date();
+            *ppvalue = Amf0Any::date(0, arena);
             return err;
         }
         case RTMP_AMF0_Invalid:
@@ -421,6 +484,79 @@ error_t Amf0Any::discovery(StreamBuf* stream, Amf0Any** ppvalue)
     }
 }
 
+Amf0Visitor::Amf0Visitor()
+{
+}
+
+Amf0Visitor::~Amf0Visitor()
+{
+}
+
+error_t Amf0Visitor::on_string(const std::string& value)
+{
+    return errorsOK;
+}
+
+error_t Amf0Visitor::on_boolean(bool value)
+{
+    return errorsOK;
+}
+
+error_t Amf0Visitor::on_number(double value)
+{
+    return errorsOK;
+}
+
+error_t Amf0Visitor::on_date(int64_t date, int16_t time_zone)
+{
+    return errorsOK;
+}
+
+error_t Amf0Visitor::on_null()
+{
+    return errorsOK;
+}
+
+error_t Amf0Visitor::on_undefined()
+{
+    return errorsOK;
+}
+
+error_t Amf0Visitor::on_object(Amf0Object* obj)
+{
+    return errorsOK;
+}
+
+error_t Amf0Visitor::on_ecma_array(Amf0EcmaArray* arr)
+{
+    return errorsOK;
+}
+
+error_t Amf0Visitor::on_strict_array(Amf0StrictArray* arr)
+{
+    return errorsOK;
+}
+
+error_t Amf0Visitor::on_object_eof()
+{
+    return errorsOK;
+}
+
+// below this count a property is found by a linear scan, which is faster
+// than hashing for the small objects of most commands.
+#define AMF0_INDEX_THRESHOLD 8
+
+// FNV-1a of the property name.
+static uint32_t amf0_hash_key(string_view key)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < key.size(); i++) {
+        h ^= (uint8_t)key[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
 UnSortedHashtable::UnSortedHashtable()
 {
 }
@@ -435,15 +571,73 @@ int UnSortedHashtable::count()
     return (int)properties.size();
 }
 
+void UnSortedHashtable::reserve(int n)
+{
+    properties.reserve(n);
+}
+
+int UnSortedHashtable::find(string_view name)
+{
+    int n = count();
+    if (n <= AMF0_INDEX_THRESHOLD) {
+        for (int i = 0; i < n; i++) {
+            if (properties[i].first == name) {
+                return i;
+            }
+        }
+        return -1;
+    }
+    
+    if (index.empty()) {
+        build_index();
+    }
+    
+    size_t mask = index.size() - 1;
+    for (size_t h = amf0_hash_key(name) & mask;; h = (h + 1) & mask) {
+        uint32_t v = index[h];
+        if (!v) {
+            return -1;
+        }
+        if (properties[v - 1].first == name) {
+            return (int)v - 1;
+        }
+    }
+}
+
+void UnSortedHashtable::build_index()
+{
+    // at most half full, the probes are short.
+    size_t size = 16;
+    while (size < properties.size() * 2) {
+        size <<= 1;
+    }
+    index.assign(size, 0);
+    
+    for (int i = 0; i < count(); i++) {
+        index_at(i);
+    }
+}
+
+void UnSortedHashtable::index_at(int i)
+{
+    size_t mask = index.size() - 1;
+    size_t h = amf0_hash_key(properties[i].first) & mask;
+    while (index[h]) {
+        h = (h + 1) & mask;
+    }
+    index[h] = (uint32_t)i + 1;
+}
+
 void UnSortedHashtable::clear()
 {
     std::vector<Amf0ObjectPropertyType>::iterator it;
     for (it = properties.begin(); it != properties.end(); ++it) {
         Amf0ObjectPropertyType& elem = *it;
         Amf0Any* any = elem.second;
-        freep(any);
+        amf0_freep(any);
     }
     properties.clear();
+    index.clear();
 }
 
 string UnSortedHashtable::key_at(int index)
@@ -460,6 +654,12 @@ const char* UnSortedHashtable::key_raw_at(int index)
     return elem.first.data();
 }
 
+string_view UnSortedHashtable::key_view_at(int index)
+{
+    assert(index < count());
+    return properties[index].first;
+}
+
 Amf0Any* UnSortedHashtable::value_at(int index)
 {
     assert(index < count());
@@ -467,44 +667,38 @@ Amf0Any* UnSortedHashtable::value_at(int index)
     return elem.second;
 }
 
-void UnSortedHashtable::set(string key, Amf0Any* value)
+void UnSortedHashtable::set(string_view key, Amf0Any* value)
 {
-    std::vector<Amf0ObjectPropertyType>::iterator it;
+    int i = find(key);
+    if (i >= 0) {
+        amf0_freep(properties[i].second);
+        properties.erase(properties.begin() + i);
+        // the positions after it are moved, rebuild when needed.
+        index.clear();
+    }
     
-    for (it = properties.begin(); it != properties.end(); ++it) {
-        Amf0ObjectPropertyType& elem = *it;
-        std::string name = elem.first;
-        Amf0Any* any = elem.second;
-        
-        if (key == name) {
-            freep(any);
-            it = properties.erase(it);
-            break;
-        }
+    if (!value) {
+        return;
     }
     
-    if (value) {
-        properties.push_back(std::make_pair(key, value));
+    // the only copy of the key.
+    properties.emplace_back(std::string(key), value);
+    if (!index.empty()) {
+        if (properties.size() * 2 > index.size()) {
+            index.clear();
+        } else {
+            index_at(count() - 1);
+        }
     }
 }
 
-Amf0Any* UnSortedHashtable::get_property(string name)
+Amf0Any* UnSortedHashtable::get_property(string_view name)
 {
-    std::vector<Amf0ObjectPropertyType>::iterator it;
-    
-    for (it = properties.begin(); it != properties.end(); ++it) {
-        Amf0ObjectPropertyType& elem = *it;
-        std::string key = elem.first;
-        Amf0Any* any = elem.second;
-        if (key == name) {
-            return any;
-        }
-    }
-    
-    return NULL;
+    int i = find(name);
+    return (i >= 0)? properties[i].second : NULL;
 }
 
-Amf0Any* UnSortedHashtable::ensure_property_string(string name)
+Amf0Any* UnSortedHashtable::ensure_property_string(string_view name)
 {
     Amf0Any* prop = get_property(name);
     
@@ -519,7 +713,7 @@ Amf0Any* UnSortedHashtable::ensure_property_string(string name)
     return prop;
 }
 
-Amf0Any* UnSortedHashtable::ensure_property_number(string name)
+Amf0Any* UnSortedHashtable::ensure_property_number(string_view name)
 {
     Amf0Any* prop = get_property(name);
     
@@ -534,22 +728,16 @@ Amf0Any* UnSortedHashtable::ensure_property_number(string name)
     return prop;
 }
 
-void UnSortedHashtable::remove(string name)
+void UnSortedHashtable::remove(string_view name)
 {
-    std::vector<Amf0ObjectPropertyType>::iterator it;
-    
-    for (it = properties.begin(); it != properties.end();) {
-        std::string key = it->first;
-        Amf0Any* any = it->second;
-        
-        if (key == name) {
-            freep(any);
-            
-            it = properties.erase(it);
-        } else {
-            ++it;
-        }
+    int i = find(name);
+    if (i < 0) {
+        return;
     }
+    
+    amf0_freep(properties[i].second);
+    properties.erase(properties.begin() + i);
+    index.clear();
 }
 
 void UnSortedHashtable::copy(UnSortedHashtable* src)
@@ -583,7 +771,7 @@ error_t Amf0ObjectEOF::read(StreamBuf* stream)
     
     // value
     if (!stream->require(2)) {
-        return errors_new(-1, "EOF requires 2 only %d bytes", stream->Remain());
+        return errors_new(-1, "EOF requires 2 only %" PRId64 " bytes", stream->Remain());
     }
     int16_t temp = stream->Read2Bytes();
     if (temp != 0x00) {
@@ -592,7 +780,7 @@ error_t Amf0ObjectEOF::read(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "EOF requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "EOF requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -609,13 +797,13 @@ error_t Amf0ObjectEOF::write(StreamBuf* stream)
     
     // value
     if (!stream->require(2)) {
-        return errors_new(-1, "EOF requires 2 only %d bytes", stream->Remain());
+        return errors_new(-1, "EOF requires 2 only %" PRId64 " bytes", stream->Remain());
     }
     stream->Write2Bytes(0x00);
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "EOF requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "EOF requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write1Bytes(RTMP_AMF0_ObjectEnd);
@@ -630,22 +818,18 @@ Amf0Any* Amf0ObjectEOF::copy()
 
 Amf0Object::Amf0Object()
 {
-    properties = new UnSortedHashtable();
-    eof = new Amf0ObjectEOF();
     marker = RTMP_AMF0_Object;
 }
 
 Amf0Object::~Amf0Object()
 {
-    freep(properties);
-    freep(eof);
 }
 
 int Amf0Object::total_size()
 {
     int size = 1;
     
-    for (int i = 0; i < properties->count(); i++){
+    for (int i = 0; i < properties.count(); i++){
         std::string name = key_at(i);
         Amf0Any* value = value_at(i);
         
@@ -664,7 +848,7 @@ error_t Amf0Object::read(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "object requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "object requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -690,8 +874,8 @@ error_t Amf0Object::read(StreamBuf* stream)
         }
         // property-value: any
         Amf0Any* property_value = NULL;
-        if ((err = amf0_read_any(stream, &property_value)) != errorsOK) {
-            freep(property_value);
+        if ((err = amf0_read_any(stream, &property_value, arena())) != errorsOK) {
+            amf0_freep(property_value);
             return errors_wrap(err, "read property value, name=%s", property_name.c_str());
         }
         
@@ -708,13 +892,13 @@ error_t Amf0Object::write(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "object requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "object requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write1Bytes(RTMP_AMF0_Object);
     
     // value
-    for (int i = 0; i < properties->count(); i++) {
+    for (int i = 0; i < properties.count(); i++) {
         std::string name = this->key_at(i);
         Amf0Any* any = this->value_at(i);
         
@@ -727,7 +911,8 @@ error_t Amf0Object::write(StreamBuf* stream)
         }
     }
     
-    if ((err = eof->write(stream)) != errorsOK) {
+    Amf0ObjectEOF eof;
+    if ((err = eof.write(stream)) != errorsOK) {
         return errors_wrap(err, "write EOF");
     }
     
@@ -737,7 +922,7 @@ error_t Amf0Object::write(StreamBuf* stream)
 Amf0Any* Amf0Object::copy()
 {
     Amf0Object* copy = new Amf0Object();
-    copy->properties->copy(properties);
+    copy->properties.copy(&properties);
     return copy;
 }
 
@@ -745,7 +930,7 @@ Amf0Any* Amf0Object::copy()
 // {
 //     SrsJsonObject* obj = SrsJsonAny::object();
     
-//     for (int i = 0; i < properties->count(); i++) {
+//     for (int i = 0; i < properties.count(); i++) {
 //         std::string name = this->key_at(i);
 //         Amf0Any* any = this->value_at(i);
         
@@ -757,73 +942,74 @@ Amf0Any* Amf0Object::copy()
 
 void Amf0Object::clear()
 {
-    properties->clear();
+    properties.clear();
 }
 
 int Amf0Object::count()
 {
-    return properties->count();
+    return properties.count();
 }
 
 string Amf0Object::key_at(int index)
 {
-    return properties->key_at(index);
+    return properties.key_at(index);
 }
 
 const char* Amf0Object::key_raw_at(int index)
 {
-    return properties->key_raw_at(index);
+    return properties.key_raw_at(index);
+}
+
+string_view Amf0Object::key_view_at(int index)
+{
+    return properties.key_view_at(index);
 }
 
 Amf0Any* Amf0Object::value_at(int index)
 {
-    return properties->value_at(index);
+    return properties.value_at(index);
 }
 
-void Amf0Object::set(string key, Amf0Any* value)
+void Amf0Object::set(string_view key, Amf0Any* value)
 {
-    properties->set(key, value);
+    properties.set(key, value);
 }
 
-Amf0Any* Amf0Object::get_property(string name)
+Amf0Any* Amf0Object::get_property(string_view name)
 {
-    return properties->get_property(name);
+    return properties.get_property(name);
 }
 
-Amf0Any* Amf0Object::ensure_property_string(string name)
+Amf0Any* Amf0Object::ensure_property_string(string_view name)
 {
-    return properties->ensure_property_string(name);
+    return properties.ensure_property_string(name);
 }
 
-Amf0Any* Amf0Object::ensure_property_number(string name)
+Amf0Any* Amf0Object::ensure_property_number(string_view name)
 {
-    return properties->ensure_property_number(name);
+    return properties.ensure_property_number(name);
 }
 
-void Amf0Object::remove(string name)
+void Amf0Object::remove(string_view name)
 {
-    properties->remove(name);
+    properties.remove(name);
 }
 
 Amf0EcmaArray::Amf0EcmaArray()
 {
     _count = 0;
-    properties = new UnSortedHashtable();
-    eof = new Amf0ObjectEOF();
     marker = RTMP_AMF0_EcmaArray;
 }
 
 Amf0EcmaArray::~Amf0EcmaArray()
 {
-    freep(properties);
-    freep(eof);
 }
 
 int Amf0EcmaArray::total_size()
 {
     int size = 1 + 4;
     
-    for (int i = 0; i < properties->count(); i++){
+    for (int i = 0; i < properties.count(); i++){
         std::string name = key_at(i);
         Amf0Any* value = value_at(i);
         
@@ -842,7 +1028,7 @@ error_t Amf0EcmaArray::read(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -852,7 +1038,7 @@ error_t Amf0EcmaArray::read(StreamBuf* stream)
     
     // count
     if (!stream->require(4)) {
-        return errors_new(-1, "requires 4 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 4 only %" PRId64 " bytes", stream->Remain());
     }
     
     int32_t count = stream->Read4Bytes();
@@ -860,6 +1046,12 @@ error_t Amf0EcmaArray::read(StreamBuf* stream)
     // value
     this->_count = count;
     
+    // the count is a hint, bounded by the bytes left, a property is at
+    // least 3 bytes, the name length and the marker.
+    if (count > 0) {
+        properties.reserve((int)std::min<int64_t>(count, stream->Remain() / 3));
+    }
+    
     while (!stream->empty()) {
         // detect whether is eof.
         if (amf0_is_object_eof(stream)) {
@@ -877,7 +1069,7 @@ error_t Amf0EcmaArray::read(StreamBuf* stream)
         }
         // property-value: any
         Amf0Any* property_value = NULL;
-        if ((err = amf0_read_any(stream, &property_value)) != errorsOK) {
+        if ((err = amf0_read_any(stream, &property_value, arena())) != errorsOK) {
             return errors_wrap(err, "read property value, name=%s", property_name.c_str());
         }
         
@@ -894,20 +1086,20 @@ error_t Amf0EcmaArray::write(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write1Bytes(RTMP_AMF0_EcmaArray);
     
     // count
     if (!stream->require(4)) {
-        return errors_new(-1, "requires 4 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 4 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write4Bytes(this->_count);
     
     // value
-    for (int i = 0; i < properties->count(); i++) {
+    for (int i = 0; i < properties.count(); i++) {
         std::string name = this->key_at(i);
         Amf0Any* any = this->value_at(i);
         
@@ -920,7 +1112,8 @@ error_t Amf0EcmaArray::write(StreamBuf* stream)
         }
     }
     
-    if ((err = eof->write(stream)) != errorsOK) {
+    Amf0ObjectEOF eof;
+    if ((err = eof.write(stream)) != errorsOK) {
         return errors_wrap(err, "write EOF");
     }
     
@@ -930,7 +1123,7 @@ error_t Amf0EcmaArray::write(StreamBuf* stream)
 Amf0Any* Amf0EcmaArray::copy()
 {
     Amf0EcmaArray* copy = new Amf0EcmaArray();
-    copy->properties->copy(properties);
+    copy->properties.copy(&properties);
     copy->_count = _count;
     return copy;
 }
@@ -939,7 +1132,7 @@ Amf0Any* Amf0EcmaArray::copy()
 // {
 //     SrsJsonObject* obj = SrsJsonAny::object();
     
-//     for (int i = 0; i < properties->count(); i++) {
+//     for (int i = 0; i < properties.count(); i++) {
 //         std::string name = this->key_at(i);
 //         Amf0Any* any = this->value_at(i);
         
@@ -951,47 +1144,52 @@ Amf0Any* Amf0EcmaArray::copy()
 
 void Amf0EcmaArray::clear()
 {
-    properties->clear();
+    properties.clear();
 }
 
 int Amf0EcmaArray::count()
 {
-    return properties->count();
+    return properties.count();
 }
 
 string Amf0EcmaArray::key_at(int index)
 {
-    return properties->key_at(index);
+    return properties.key_at(index);
 }
 
 const char* Amf0EcmaArray::key_raw_at(int index)
 {
-    return properties->key_raw_at(index);
+    return properties.key_raw_at(index);
+}
+
+string_view Amf0EcmaArray::key_view_at(int index)
+{
+    return properties.key_view_at(index);
 }
 
 Amf0Any* Amf0EcmaArray::value_at(int index)
 {
-    return properties->value_at(index);
+    return properties.value_at(index);
 }
 
-void Amf0EcmaArray::set(string key, Amf0Any* value)
+void Amf0EcmaArray::set(string_view key, Amf0Any* value)
 {
-    properties->set(key, value);
+    properties.set(key, value);
 }
 
-Amf0Any* Amf0EcmaArray::get_property(string name)
+Amf0Any* Amf0EcmaArray::get_property(string_view name)
 {
-    return properties->get_property(name);
+    return properties.get_property(name);
 }
 
-Amf0Any* Amf0EcmaArray::ensure_property_string(string name)
+Amf0Any* Amf0EcmaArray::ensure_property_string(string_view name)
 {
-    return properties->ensure_property_string(name);
+    return properties.ensure_property_string(name);
 }
 
-Amf0Any* Amf0EcmaArray::ensure_property_number(string name)
+Amf0Any* Amf0EcmaArray::ensure_property_number(string_view name)
 {
-    return properties->ensure_property_number(name);
+    return properties.ensure_property_number(name);
 }
 
 Amf0StrictArray::Amf0StrictArray()
@@ -1023,7 +1221,7 @@ error_t Amf0StrictArray::read(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -1033,7 +1231,7 @@ error_t Amf0StrictArray::read(StreamBuf* stream)
     
     // count
     if (!stream->require(4)) {
-        return errors_new(-1, "requires 4 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 4 only %" PRId64 " bytes", stream->Remain());
     }
     
     int32_t count = stream->Read4Bytes();
@@ -1041,10 +1239,15 @@ error_t Amf0StrictArray::read(StreamBuf* stream)
     // value
     this->_count = count;
     
+    // an elem is at least the 1 byte marker.
+    if (count > 0) {
+        properties.reserve((size_t)std::min<int64_t>(count, stream->Remain()));
+    }
+    
     for (int i = 0; i < count && !stream->empty(); i++) {
         // property-value: any
         Amf0Any* elem = NULL;
-        if ((err = amf0_read_any(stream, &elem)) != errorsOK) {
+        if ((err = amf0_read_any(stream, &elem, arena())) != errorsOK) {
             return errors_wrap(err, "read property");
         }
         
@@ -1061,14 +1264,14 @@ error_t Amf0StrictArray::write(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write1Bytes(RTMP_AMF0_StrictArray);
     
     // count
     if (!stream->require(4)) {
-        return errors_new(-1, "requires 4 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 4 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write4Bytes(this->_count);
@@ -1117,7 +1320,7 @@ void Amf0StrictArray::clear()
     std::vector<Amf0Any*>::iterator it;
     for (it = properties.begin(); it != properties.end(); ++it) {
         Amf0Any* any = *it;
-        freep(any);
+        amf0_freep(any);
     }
     properties.clear();
 }
@@ -1332,7 +1535,7 @@ error_t Amf0Date::read(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -1345,7 +1548,7 @@ error_t Amf0Date::read(StreamBuf* stream)
     // elapsed since the epoch of midnight on 1st Jan 1970 in the UTC
     // time zone.
     if (!stream->require(8)) {
-        return errors_new(-1, "requires 8 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 8 only %" PRId64 " bytes", stream->Remain());
     }
     
     _date_value = stream->Read8Bytes();
@@ -1356,7 +1559,7 @@ error_t Amf0Date::read(StreamBuf* stream)
     // to change time zones when serializing dates on a network. It is suggested
     // that the time zone be queried independently as needed.
     if (!stream->require(2)) {
-        return errors_new(-1, "requires 2 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 2 only %" PRId64 " bytes", stream->Remain());
     }
     
     _time_zone = stream->Read2Bytes();
@@ -1370,21 +1573,21 @@ error_t Amf0Date::write(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write1Bytes(RTMP_AMF0_Date);
     
     // date value
     if (!stream->require(8)) {
-        return errors_new(-1, "requires 8 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 8 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write8Bytes(_date_value);
     
     // time zone
     if (!stream->require(2)) {
-        return errors_new(-1, "requires 2 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 2 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write2Bytes(_time_zone);
@@ -1472,21 +1675,144 @@ Amf0Any* Amf0Undefined::copy()
     return copy;
 }
 
-error_t amf0_read_any(StreamBuf* stream, Amf0Any** ppvalue)
+error_t amf0_read_any(StreamBuf* stream, Amf0Any** ppvalue, Arena* arena)
 {
     error_t err = errorsOK;
     
-    if ((err = Amf0Any::discovery(stream, ppvalue)) != errorsOK) {
+    if ((err = Amf0Any::discovery(stream, ppvalue, arena)) != errorsOK) {
         return errors_wrap(err, "discovery");
     }
     
     assert(*ppvalue);
     
     if ((err = (*ppvalue)->read(stream)) != errorsOK) {
-        freep(*ppvalue);
+        amf0_freep(*ppvalue);
         return errors_wrap(err, "parse elem");
     }
     
+    // a read without require() is clamped to the end, but it's an error.
+    if (stream->Overflowed()) {
+        amf0_freep(*ppvalue);
+        return errors_new(ERROR_STREAM_EOF, "read over the end of the stream");
+    }
+    
+    return err;
+}
+
+static error_t amf0_do_write_any(ByteBuffer* out, Amf0Any* value);
+
+static error_t amf0_write_utf8(ByteBuffer* out, string_view value)
+{
+    if (value.size() > 0xffff) {
+        return errors_new(-1, "utf8 of %d bytes over 65535", (int)value.size());
+    }
+    out->Write2Bytes((uint16_t)value.size());
+    out->WriteBytes(value.data(), (int64_t)value.size());
+    return errorsOK;
+}
+
+// the properties, the object-eof, and the count patched at mark when >= 0.
+template <typename T>
+static error_t amf0_write_properties(ByteBuffer* out, T* obj, int64_t mark)
+{
+    error_t err = errorsOK;
+    
+    for (int i = 0; i < obj->count(); i++) {
+        string_view name = obj->key_view_at(i);
+        if ((err = amf0_write_utf8(out, name)) != errorsOK) {
+            return errors_wrap(err, "write property name");
+        }
+        if ((err = amf0_do_write_any(out, obj->value_at(i))) != errorsOK) {
+            return errors_wrap(err, "write property value, name=%.*s", (int)name.size(), name.data());
+        }
+    }
+    
+    out->Write2Bytes(0);
+    out->Write1Bytes(RTMP_AMF0_ObjectEnd);
+    
+    if (mark >= 0) {
+        out->Patch4Bytes(mark, (uint32_t)obj->count());
+    }
+    return err;
+}
+
+static error_t amf0_do_write_any(ByteBuffer* out, Amf0Any* value)
+{
+    error_t err = errorsOK;
+    
+    switch (value->marker) {
+        case RTMP_AMF0_String: {
+            out->Write1Bytes(RTMP_AMF0_String);
+            return amf0_write_utf8(out, static_cast<Amf0String*>(value)->value);
+        }
+        case RTMP_AMF0_Boolean: {
+            out->Write1Bytes(RTMP_AMF0_Boolean);
+            out->Write1Bytes(value->to_boolean()? 1 : 0);
+            return err;
+        }
+        case RTMP_AMF0_Number: {
+            double number = value->to_number();
+            int64_t temp;
+            memcpy(&temp, &number, 8);
+            out->Write1Bytes(RTMP_AMF0_Number);
+            out->Write8Bytes(temp);
+            return err;
+        }
+        case RTMP_AMF0_Date: {
+            out->Write1Bytes(RTMP_AMF0_Date);
+            out->Write8Bytes(value->to_date());
+            out->Write2Bytes((uint16_t)value->to_date_time_zone());
+            return err;
+        }
+        case RTMP_AMF0_Null:
+        case RTMP_AMF0_Undefined: {
+            out->Write1Bytes(value->marker);
+            return err;
+        }
+        case RTMP_AMF0_ObjectEnd: {
+            out->Write2Bytes(0);
+            out->Write1Bytes(RTMP_AMF0_ObjectEnd);
+            return err;
+        }
+        case RTMP_AMF0_Object: {
+            out->Write1Bytes(RTMP_AMF0_Object);
+            return amf0_write_properties(out, value->to_object(), -1);
+        }
+        case RTMP_AMF0_EcmaArray: {
+            out->Write1Bytes(RTMP_AMF0_EcmaArray);
+            // the count, patched when the properties are written.
+            int64_t mark = out->Mark();
+            out->Write4Bytes(0);
+            return amf0_write_properties(out, value->to_ecma_array(), mark);
+        }
+        case RTMP_AMF0_StrictArray: {
+            Amf0StrictArray* arr = value->to_strict_array();
+            out->Write1Bytes(RTMP_AMF0_StrictArray);
+            int64_t mark = out->Mark();
+            out->Write4Bytes(0);
+            for (int i = 0; i < arr->count(); i++) {
+                if ((err = amf0_do_write_any(out, arr->at(i))) != errorsOK) {
+                    return errors_wrap(err, "write elem %d", i);
+                }
+            }
+            out->Patch4Bytes(mark, (uint32_t)arr->count());
+            return err;
+        }
+        default:
+            return errors_new(-1, "write invalid marker=%#x", value->marker);
+    }
+}
+
+error_t amf0_write_any(ByteBuffer* out, Amf0Any* value)
+{
+    error_t err = errorsOK;
+    
+    int64_t mark = out->Mark();
+    if ((err = amf0_do_write_any(out, value)) != errorsOK) {
+        out->Truncate(mark);
+        return errors_wrap(err, "write elem");
+    }
+    
     return err;
 }
 
@@ -1494,7 +1820,7 @@ error_t srs_amf0_read_string(StreamBuf* stream, string& value)
 {
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -1509,7 +1835,7 @@ error_t srs_amf0_write_string(StreamBuf* stream, string value)
 {   
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write1Bytes(RTMP_AMF0_String);
@@ -1523,7 +1849,7 @@ error_t srs_amf0_read_boolean(StreamBuf* stream, bool& value)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -1533,7 +1859,7 @@ error_t srs_amf0_read_boolean(StreamBuf* stream, bool& value)
     
     // value
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     value = (stream->Read1Byte() != 0);
@@ -1547,13 +1873,13 @@ error_t srs_amf0_write_boolean(StreamBuf* stream, bool value)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     stream->Write1Bytes(RTMP_AMF0_Boolean);
     
     // value
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     if (value) {
@@ -1571,7 +1897,7 @@ error_t srs_amf0_read_number(StreamBuf* stream, double& value)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -1581,7 +1907,7 @@ error_t srs_amf0_read_number(StreamBuf* stream, double& value)
     
     // value
     if (!stream->require(8)) {
-        return errors_new(-1, "requires 8 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 8 only %" PRId64 " bytes", stream->Remain());
     }
     
     int64_t temp = stream->Read8Bytes();
@@ -1596,14 +1922,14 @@ error_t srs_amf0_write_number(StreamBuf* stream, double value)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write1Bytes(RTMP_AMF0_Number);
     
     // value
     if (!stream->require(8)) {
-        return errors_new(-1, "requires 8 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 8 only %" PRId64 " bytes", stream->Remain());
     }
     
     int64_t temp = 0x00;
@@ -1619,7 +1945,7 @@ error_t srs_amf0_read_null(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -1636,7 +1962,7 @@ error_t srs_amf0_write_null(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write1Bytes(RTMP_AMF0_Null);
@@ -1650,7 +1976,7 @@ error_t srs_amf0_read_undefined(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     char marker = stream->Read1Byte();
@@ -1667,7 +1993,7 @@ error_t srs_amf0_write_undefined(StreamBuf* stream)
     
     // marker
     if (!stream->require(1)) {
-        return errors_new(-1, "requires 1 only %d bytes", stream->Remain());
+        return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
     }
     
     stream->Write1Bytes(RTMP_AMF0_Undefined);
@@ -1683,7 +2009,7 @@ error_t srs_amf0_write_undefined(StreamBuf* stream)
         
         // len
         if (!stream->require(2)) {
-            return errors_new(-1, "requires 2 only %d bytes", stream->Remain());
+            return errors_new(-1, "requires 2 only %" PRId64 " bytes", stream->Remain());
         }
         int16_t len = stream->Read2Bytes();
         
@@ -1722,7 +2048,7 @@ error_t srs_amf0_write_undefined(StreamBuf* stream)
         
         // len
         if (!stream->require(2)) {
-            return errors_new(-1, "requires 2 only %d bytes", stream->Remain());
+            return errors_new(-1, "requires 2 only %" PRId64 " bytes", stream->Remain());
         }
         stream->Write2Bytes((int16_t)value.length());
         
@@ -1733,7 +2059,7 @@ error_t srs_amf0_write_undefined(StreamBuf* stream)
         
         // data
         if (!stream->require((int)value.length())) {
-            return errors_new(-1, "requires %" PRIu64 " only %d bytes", value.length(), stream->Remain());
+            return errors_new(-1, "requires %" PRIu64 " only %" PRId64 " bytes", (uint64_t)value.length(), stream->Remain());
         }
         stream->write_string(value);
         
@@ -1742,12 +2068,9 @@ error_t srs_amf0_write_undefined(StreamBuf* stream)
     
     bool amf0_is_object_eof(StreamBuf* stream)
     {
-        // detect the object-eof specially
+        // detect the object-eof specially, peek in place.
         if (stream->require(3)) {
-            int32_t flag = stream->Read3Bytes();
-            stream->Skip(-3);
-            
-            return 0x09 == flag;
+            return 0x09 == be_read24(stream->head());
         }
         
         return false;
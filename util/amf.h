@@ -1,10 +1,40 @@
 #ifndef PROTOCOL_AMF0_HPP
 #define PROTOCOL_AMF0_HPP
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "common.h"
 #include "streambuf.h"
+#include "bytebuffer.h"
+#include "arena.h"
+
+// AMF0 marker, switch on Amf0Any::marker to dispatch by type.
+#define RTMP_AMF0_Number                     0x00
+#define RTMP_AMF0_Boolean                     0x01
+#define RTMP_AMF0_String                     0x02
+#define RTMP_AMF0_Object                     0x03
+#define RTMP_AMF0_MovieClip                 0x04 // reserved, not supported
+#define RTMP_AMF0_Null                         0x05
+#define RTMP_AMF0_Undefined                 0x06
+#define RTMP_AMF0_Reference                 0x07
+#define RTMP_AMF0_EcmaArray                 0x08
+#define RTMP_AMF0_ObjectEnd                 0x09
+#define RTMP_AMF0_StrictArray                 0x0A
+#define RTMP_AMF0_Date                         0x0B
+#define RTMP_AMF0_LongString                 0x0C
+#define RTMP_AMF0_UnSupported                 0x0D
+#define RTMP_AMF0_RecordSet                 0x0E // reserved, not supported
+#define RTMP_AMF0_XmlDocument                 0x0F
+#define RTMP_AMF0_TypedObject                 0x10
+// AVM+ object is the AMF3 object.
+#define RTMP_AMF0_AVMplusObject             0x11
+// origin array whos data takes the same form as LengthValueBytes
+#define RTMP_AMF0_OriginStrictArray         0x20
+
+// User defined
+#define RTMP_AMF0_Invalid                     0x3F
+
 // internal objects, user should never use it.
 
 class UnSortedHashtable;
@@ -13,6 +43,7 @@ class Amf0Date;
 class Amf0Object;
 class Amf0EcmaArray;
 class Amf0StrictArray;
+class Amf0Visitor;
 /*
  ////////////////////////////////////////////////////////////////////////
  ////////////////////////////////////////////////////////////////////////
@@ -99,6 +130,25 @@ public:
 public:
     Amf0Any();
     virtual ~Amf0Any();
+    // allocation, on the heap or in an arena.
+private:
+    // where the instance is, set by the factories, NULL on the heap.
+    Arena* _arena;
+public:
+    static void* operator new(size_t size);
+    static void* operator new(size_t size, Arena* arena);
+    static void operator delete(void* p);
+    static void operator delete(void* p, Arena* arena);
+    /**
+     * free the instance created by the factories, on the heap or in an
+     * arena, use amf0_freep() instead of freep() for a tree in an arena.
+     */
+    static void destroy(Amf0Any* v);
+    /**
+     * the arena of the instance, NULL if on the heap, the children of a
+     * complex object are read into the same arena.
+     */
+    Arena* arena();
     // type identify, user should identify the type then convert from/to value.
 public:
     /**
@@ -206,6 +256,12 @@ public:
      * @remark assert is_strict_array(), user must ensure the type then convert.
      */
     virtual Amf0StrictArray* to_strict_array();
+    /**
+     * call the method of the visitor for the type, by a switch on the marker.
+     * @remark the visitor is not called for the children of a complex
+     *       object, it visits them by itself when needed.
+     */
+    error_t visit(Amf0Visitor* v);
     // set value of instance
 public:
     /**
@@ -248,53 +304,133 @@ public:
     /**
      * create an AMF0 string instance, set string content by value.
      */
-    static Amf0Any* str(const char* value = NULL);
+    static Amf0Any* str(const char* value = NULL, Arena* arena = NULL);
     /**
      * create an AMF0 boolean instance, set boolean content by value.
      */
-    static Amf0Any* boolean(bool value = false);
+    static Amf0Any* boolean(bool value = false, Arena* arena = NULL);
     /**
      * create an AMF0 number instance, set number content by value.
      */
-    static Amf0Any* number(double value = 0.0);
+    static Amf0Any* number(double value = 0.0, Arena* arena = NULL);
     /**
      * create an AMF0 date instance
      */
-    static Amf0Any* date(int64_t value = 0);
+    static Amf0Any* date(int64_t value = 0, Arena* arena = NULL);
     /**
      * create an AMF0 null instance
      */
-    static Amf0Any* null();
+    static Amf0Any* null(Arena* arena = NULL);
     /**
      * create an AMF0 undefined instance
      */
-    static Amf0Any* undefined();
+    static Amf0Any* undefined(Arena* arena = NULL);
     /**
      * create an AMF0 empty object instance
      */
-    static Amf0Object* object();
+    static Amf0Object* object(Arena* arena = NULL);
     /**
      * create an AMF0 object-EOF instance
      */
-    static Amf0Any* object_eof();
+    static Amf0Any* object_eof(Arena* arena = NULL);
     /**
      * create an AMF0 empty ecma-array instance
      */
-    static Amf0EcmaArray* ecma_array();
+    static Amf0EcmaArray* ecma_array(Arena* arena = NULL);
     /**
      * create an AMF0 empty strict-array instance
      */
-    static Amf0StrictArray* strict_array();
+    static Amf0StrictArray* strict_array(Arena* arena = NULL);
     // discovery instance from stream
 public:
     /**
      * discovery AMF0 instance from stream
      * @param ppvalue, output the discoveried AMF0 instance.
      *       NULL if error.
+     * @param arena, where to create the instance, NULL for the heap.
      * @remark, instance is created without read from stream, user must
      *       use (*ppvalue)->read(stream) to get the instance.
      */
-    static error_t discovery(StreamBuf* stream, Amf0Any** ppvalue);
+    static error_t discovery(StreamBuf* stream, Amf0Any** ppvalue, Arena* arena = NULL);
+};
+
+/**
+ * free an amf0 instance and set it to NULL, like freep() but also for an
+ * instance in an arena.
+ */
+#define amf0_freep(p) \
+    if (p) { \
+        Amf0Any::destroy(p); \
+        p = NULL; \
+    } \
+    (void)0
+
+/**
+ * the receiver of Amf0Any::visit(), one method per type with the value
+ * converted, every method does nothing by default.
+ */
+class Amf0Visitor
+{
+public:
+    Amf0Visitor();
+    virtual ~Amf0Visitor();
+public:
+    virtual error_t on_string(const std::string& value);
+    virtual error_t on_boolean(bool value);
+    virtual error_t on_number(double value);
+    virtual error_t on_date(int64_t date, int16_t time_zone);
+    virtual error_t on_null();
+    virtual error_t on_undefined();
+    virtual error_t on_object(Amf0Object* obj);
+    virtual error_t on_ecma_array(Amf0EcmaArray* arr);
+    virtual error_t on_strict_array(Amf0StrictArray* arr);
+    virtual error_t on_object_eof();
+};
+
+/**
+ * to ensure in inserted order.
+ * for the FMLE will crash when AMF0Object is not ordered by inserted,
+ * if ordered in map, the string compare order, the FMLE will creash when
+ * get the response of connect app.
+ */
+class UnSortedHashtable
+{
+private:
+    typedef std::pair<std::string, Amf0Any*> Amf0ObjectPropertyType;
+    std::vector<Amf0ObjectPropertyType> properties;
+    // the open addressing index of the properties by name, built when
+    // looked up past a few properties, a slot is the position + 1, 0 if
+    // empty. cleared when a property is erased, the positions are moved.
+    std::vector<uint32_t> index;
+public:
+    UnSortedHashtable();
+    virtual ~UnSortedHashtable();
+public:
+    virtual int count();
+    virtual void clear();
+    // make room for n properties, for a known count.
+    virtual void reserve(int n);
+    virtual std::string key_at(int index);
+    virtual const char* key_raw_at(int index);
+    virtual std::string_view key_view_at(int index);
+    virtual Amf0Any* value_at(int index);
+    /**
+     * set the value of hashtable.
+     * @param value, the value to set. NULL to delete the property.
+     */
+    virtual void set(std::string_view key, Amf0Any* value);
+public:
+    virtual Amf0Any* get_property(std::string_view name);
+    virtual Amf0Any* ensure_property_string(std::string_view name);
+    virtual Amf0Any* ensure_property_number(std::string_view name);
+    virtual void remove(std::string_view name);
+public:
+    virtual void copy(UnSortedHashtable* src);
+private:
+    // the position of the property, -1 if not found.
+    int find(std::string_view name);
+    void build_index();
+    void index_at(int i);
 };
 
 /**
@@ -305,8 +441,7 @@ public:
 class Amf0Object : public Amf0Any
 {
 private:
-    UnSortedHashtable* properties;
-    Amf0ObjectEOF* eof;
+    UnSortedHashtable properties;
 private:
     friend class Amf0Any;
     /**
@@ -347,6 +482,11 @@ public:
      * @remark: max index is count().
      */
     virtual const char* key_raw_at(int index);
+    /**
+     * get the property(key:value) key at index, without a copy.
+     * @remark: max index is count().
+     */
+    virtual std::string_view key_view_at(int index);
     /**
      * get the property(key:value) value at index.
      * @remark: max index is count().
@@ -360,30 +500,30 @@ public:
      * @param value, an AMF0 instance property value.
      * @remark user should never free the value, this instance will manage it.
      */
-    virtual void set(std::string key, Amf0Any* value);
+    virtual void set(std::string_view key, Amf0Any* value);
     /**
      * get the property(key:value) of object,
      * @param name, the property name/key
      * @return the property AMF0 value, NULL if not found.
      * @remark user should never free the returned value, copy it if needed.
      */
-    virtual Amf0Any* get_property(std::string name);
+    virtual Amf0Any* get_property(std::string_view name);
     /**
      * get the string property, ensure the property is_string().
      * @return the property AMF0 value, NULL if not found, or not a string.
      * @remark user should never free the returned value, copy it if needed.
      */
-    virtual Amf0Any* ensure_property_string(std::string name);
+    virtual Amf0Any* ensure_property_string(std::string_view name);
     /**
      * get the number property, ensure the property is_number().
      * @return the property AMF0 value, NULL if not found, or not a number.
      * @remark user should never free the returned value, copy it if needed.
      */
-    virtual Amf0Any* ensure_property_number(std::string name);
+    virtual Amf0Any* ensure_property_number(std::string_view name);
     /**
      * remove the property specified by name.
      */
-    virtual void remove(std::string name);
+    virtual void remove(std::string_view name);
 };
 
 /**
@@ -395,8 +535,7 @@ public:
 class Amf0EcmaArray : public Amf0Any
 {
 private:
-    UnSortedHashtable* properties;
-    Amf0ObjectEOF* eof;
+    UnSortedHashtable properties;
     int32_t _count;
 private:
     friend class Amf0Any;
@@ -438,6 +577,11 @@ public:
      * @remark: max index is count().
      */
     virtual const char* key_raw_at(int index);
+    /**
+     * get the property(key:value) key at index, without a copy.
+     * @remark: max index is count().
+     */
+    virtual std::string_view key_view_at(int index);
     /**
      * get the property(key:value) value at index.
      * @remark: max index is count().
@@ -451,26 +595,26 @@ public:
      * @param value, an AMF0 instance property value.
      * @remark user should never free the value, this instance will manage it.
      */
-    virtual void set(std::string key, Amf0Any* value);
+    virtual void set(std::string_view key, Amf0Any* value);
     /**
      * get the property(key:value) of array,
      * @param name, the property name/key
      * @return the property AMF0 value, NULL if not found.
      * @remark user should never free the returned value, copy it if needed.
      */
-    virtual Amf0Any* get_property(std::string name);
+    virtual Amf0Any* get_property(std::string_view name);
     /**
      * get the string property, ensure the property is_string().
      * @return the property AMF0 value, NULL if not found, or not a string.
      * @remark user should never free the returned value, copy it if needed.
      */
-    virtual Amf0Any* ensure_property_string(std::string name);
+    virtual Amf0Any* ensure_property_string(std::string_view name);
     /**
      * get the number property, ensure the property is_number().
      * @return the property AMF0 value, NULL if not found, or not a number.
      * @remark user should never free the returned value, copy it if needed.
      */
-    virtual Amf0Any* ensure_property_number(std::string name);
+    virtual Amf0Any* ensure_property_number(std::string_view name);
 };
 
 /**
@@ -551,8 +695,17 @@ public:
  * read anything from stream.
  * @param ppvalue, the output amf0 any elem.
  *         NULL if error; otherwise, never NULL and user must free it.
+ * @param arena, where to create the tree, NULL for the heap. the tree is
+ *         freed by amf0_freep(), then Reset() of the arena releases its memory.
  */
-extern error_t amf0_read_any(StreamBuf* stream, Amf0Any** ppvalue);
+extern error_t amf0_read_any(StreamBuf* stream, Amf0Any** ppvalue, Arena* arena = NULL);
+
+/**
+ * append the amf0 value to the output buffer, which grows as it's
+ * written, the counts of the arrays are back-patched, so the sizes are
+ * never computed first. nothing is appended if error.
+ */
+extern error_t amf0_write_any(ByteBuffer* out, Amf0Any* value);
 
 /**
  * read amf0 string from stream.
@@ -761,40 +914,6 @@ extern error_t srs_amf0_write_undefined(StreamBuf* stream);
         virtual Amf0Any* copy();
     };
     
-    /**
-     * to ensure in inserted order.
-     * for the FMLE will crash when AMF0Object is not ordered by inserted,
-     * if ordered in map, the string compare order, the FMLE will creash when
-     * get the response of connect app.
-     */
-    class UnSortedHashtable
-    {
-    private:
-        typedef std::pair<std::string, Amf0Any*> Amf0ObjectPropertyType;
-        std::vector<Amf0ObjectPropertyType> properties;
-    public:
-        UnSortedHashtable();
-        virtual ~UnSortedHashtable();
-    public:
-        virtual int count();
-        virtual void clear();
-        virtual std::string key_at(int index);
-        virtual const char* key_raw_at(int index);
-        virtual Amf0Any* value_at(int index);
-        /**
-         * set the value of hashtable.
-         * @param value, the value to set. NULL to delete the property.
-         */
-        virtual void set(std::string key, Amf0Any* value);
-    public:
-        virtual Amf0Any* get_property(std::string name);
-        virtual Amf0Any* ensure_property_string(std::string name);
-        virtual Amf0Any* ensure_property_number(std::string name);
-        virtual void remove(std::string name);
-    public:
-        virtual void copy(UnSortedHashtable* src);
-    };
-    
     /**
      * 2.11 Object End Type
      * object-end-type = UTF-8-empty object-end-marker
@@ -0,0 +1,223 @@
+#include "amfreader.h"
+
+// the deepest nesting of complex values, the reader is recursive.
+#define AMF0_READER_MAX_DEPTH 64
+
+Amf0Handler::Amf0Handler()
+{
+}
+
+Amf0Handler::~Amf0Handler()
+{
+}
+
+error_t Amf0Handler::on_number(std::string_view key, double value)
+{
+    return errorsOK;
+}
+
+error_t Amf0Handler::on_boolean(std::string_view key, bool value)
+{
+    return errorsOK;
+}
+
+error_t Amf0Handler::on_string(std::string_view key, std::string_view value)
+{
+    return errorsOK;
+}
+
+error_t Amf0Handler::on_date(std::string_view key, int64_t date, int16_t time_zone)
+{
+    return errorsOK;
+}
+
+error_t Amf0Handler::on_null(std::string_view key)
+{
+    return errorsOK;
+}
+
+error_t Amf0Handler::on_undefined(std::string_view key)
+{
+    return errorsOK;
+}
+
+error_t Amf0Handler::on_begin_object(std::string_view key)
+{
+    return errorsOK;
+}
+
+error_t Amf0Handler::on_begin_ecma_array(std::string_view key, int32_t count)
+{
+    return errorsOK;
+}
+
+error_t Amf0Handler::on_begin_strict_array(std::string_view key, int32_t count)
+{
+    return errorsOK;
+}
+
+error_t Amf0Handler::on_end()
+{
+    return errorsOK;
+}
+
+// the view of the next n bytes, then skip them.
+static inline std::string_view amf0_read_view(StreamBuf* stream, int n)
+{
+    std::string_view v(stream->head(), n);
+    stream->Skip(n);
+    return v;
+}
+
+static error_t amf0_do_read_events(StreamBuf* stream, std::string_view key, Amf0Handler* h, int depth);
+
+// the properties to the object-eof, or to the end of the stream like
+// Amf0Object::read(), then on_end().
+static error_t amf0_read_properties(StreamBuf* stream, Amf0Handler* h, int depth)
+{
+    error_t err = errorsOK;
+
+    while (!stream->empty()) {
+        if (amf0_is_object_eof(stream)) {
+            stream->Skip(3);
+            break;
+        }
+
+        // property-name: utf8 string
+        if (!stream->require(2)) {
+            return errors_new(-1, "name requires 2 only %" PRId64 " bytes", stream->Remain());
+        }
+        int len = (uint16_t)stream->Read2Bytes();
+        if (!stream->require(len)) {
+            return errors_new(-1, "name requires %d only %" PRId64 " bytes", len, stream->Remain());
+        }
+        std::string_view name = amf0_read_view(stream, len);
+
+        // property-value: any
+        if ((err = amf0_do_read_events(stream, name, h, depth + 1)) != errorsOK) {
+            return errors_wrap(err, "property %.*s", len, name.data());
+        }
+    }
+
+    return h->on_end();
+}
+
+static error_t amf0_do_read_events(StreamBuf* stream, std::string_view key, Amf0Handler* h, int depth)
+{
+    error_t err = errorsOK;
+
+    if (depth > AMF0_READER_MAX_DEPTH) {
+        return errors_new(-1, "nested over %d", AMF0_READER_MAX_DEPTH);
+    }
+
+    // a stray object-eof carries no value.
+    if (amf0_is_object_eof(stream)) {
+        stream->Skip(3);
+        return err;
+    }
+
+    if (!stream->require(1)) {
+        return errors_new(-1, "marker requires 1 only %" PRId64 " bytes", stream->Remain());
+    }
+    char marker = stream->Read1Byte();
+
+    switch (marker) {
+        case RTMP_AMF0_Number: {
+            if (!stream->require(8)) {
+                return errors_new(-1, "requires 8 only %" PRId64 " bytes", stream->Remain());
+            }
+            int64_t temp = stream->Read8Bytes();
+            double value;
+            memcpy(&value, &temp, 8);
+            return h->on_number(key, value);
+        }
+        case RTMP_AMF0_Boolean: {
+            if (!stream->require(1)) {
+                return errors_new(-1, "requires 1 only %" PRId64 " bytes", stream->Remain());
+            }
+            return h->on_boolean(key, stream->Read1Byte() != 0);
+        }
+        case RTMP_AMF0_String: {
+            if (!stream->require(2)) {
+                return errors_new(-1, "requires 2 only %" PRId64 " bytes", stream->Remain());
+            }
+            int len = (uint16_t)stream->Read2Bytes();
+            if (!stream->require(len)) {
+                return errors_new(-1, "requires %d only %" PRId64 " bytes", len, stream->Remain());
+            }
+            return h->on_string(key, amf0_read_view(stream, len));
+        }
+        case RTMP_AMF0_LongString: {
+            if (!stream->require(4)) {
+                return errors_new(-1, "requires 4 only %" PRId64 " bytes", stream->Remain());
+            }
+            uint32_t len = stream->Read4Bytes();
+            if (!stream->require(len)) {
+                return errors_new(-1, "requires %u only %" PRId64 " bytes", len, stream->Remain());
+            }
+            return h->on_string(key, amf0_read_view(stream, len));
+        }
+        case RTMP_AMF0_Date: {
+            if (!stream->require(10)) {
+                return errors_new(-1, "requires 10 only %" PRId64 " bytes", stream->Remain());
+            }
+            int64_t date = stream->Read8Bytes();
+            int16_t time_zone = stream->Read2Bytes();
+            return h->on_date(key, date, time_zone);
+        }
+        case RTMP_AMF0_Null:
+            return h->on_null(key);
+        case RTMP_AMF0_Undefined:
+            return h->on_undefined(key);
+        case RTMP_AMF0_Object: {
+            if ((err = h->on_begin_object(key)) != errorsOK) {
+                return err;
+            }
+            return amf0_read_properties(stream, h, depth);
+        }
+        case RTMP_AMF0_EcmaArray: {
+            if (!stream->require(4)) {
+                return errors_new(-1, "requires 4 only %" PRId64 " bytes", stream->Remain());
+            }
+            int32_t count = stream->Read4Bytes();
+            if ((err = h->on_begin_ecma_array(key, count)) != errorsOK) {
+                return err;
+            }
+            return amf0_read_properties(stream, h, depth);
+        }
+        case RTMP_AMF0_StrictArray: {
+            if (!stream->require(4)) {
+                return errors_new(-1, "requires 4 only %" PRId64 " bytes", stream->Remain());
+            }
+            int32_t count = stream->Read4Bytes();
+            if ((err = h->on_begin_strict_array(key, count)) != errorsOK) {
+                return err;
+            }
+            // the elems to the count, or to the end of the stream like
+            // Amf0StrictArray::read().
+            for (int32_t i = 0; i < count && !stream->empty(); i++) {
+                if ((err = amf0_do_read_events(stream, std::string_view(), h, depth + 1)) != errorsOK) {
+                    return errors_wrap(err, "elem %d", i);
+                }
+            }
+            return h->on_end();
+        }
+        default:
+            return errors_new(-1, "invalid amf0 message, marker=%#x", marker);
+    }
+}
+
+error_t amf0_read_events(StreamBuf* stream, Amf0Handler* handler)
+{
+    error_t err = errorsOK;
+
+    if ((err = amf0_do_read_events(stream, std::string_view(), handler, 0)) != errorsOK) {
+        return err;
+    }
+
+    // a read without require() is clamped to the end, but it's an error.
+    if (stream->Overflowed()) {
+        return errors_new(ERROR_STREAM_EOF, "read over the end of the stream");
+    }
+    return err;
+}
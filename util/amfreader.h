@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string_view>
+
+#include "common.h"
+#include "amf.h"
+
+/**
+ * the receiver of amf0_read_events(), called in the order of the bytes.
+ * key is the property name of the value, empty for a top level value or
+ * an elem of a strict array. a complex value is a begin event, the events
+ * of its children, then on_end().
+ * strings and keys are views into the stream, valid in the callback only.
+ * every method does nothing by default, an error stops the reader.
+ */
+class Amf0Handler
+{
+public:
+    Amf0Handler();
+    virtual ~Amf0Handler();
+public:
+    virtual error_t on_number(std::string_view key, double value);
+    virtual error_t on_boolean(std::string_view key, bool value);
+    virtual error_t on_string(std::string_view key, std::string_view value);
+    virtual error_t on_date(std::string_view key, int64_t date, int16_t time_zone);
+    virtual error_t on_null(std::string_view key);
+    virtual error_t on_undefined(std::string_view key);
+    virtual error_t on_begin_object(std::string_view key);
+    // count is the declared count, a hint only.
+    virtual error_t on_begin_ecma_array(std::string_view key, int32_t count);
+    virtual error_t on_begin_strict_array(std::string_view key, int32_t count);
+    virtual error_t on_end();
+};
+
+/**
+ * read the next amf0 value of the stream as events, nothing is allocated
+ * and the memory doesn't grow with the count of properties or elems.
+ * @remark nesting is limited to 64 levels.
+ */
+extern error_t amf0_read_events(StreamBuf* stream, Amf0Handler* handler);
@@ -0,0 +1,312 @@
+#include "amfview.h"
+#include "byteorder.h"
+#include <algorithm>
+
+// the deepest nesting of complex values, the walk is recursive.
+#define AMF0_VIEW_MAX_DEPTH 64
+
+static inline bool amf0_view_is_eof(const char* p, int64_t size)
+{
+    return size >= 3 && p[0] == 0x00 && p[1] == 0x00 && p[2] == RTMP_AMF0_ObjectEnd;
+}
+
+static error_t amf0_do_extent(const char* p, int64_t size, int depth, int64_t* psize);
+
+// the extent of the properties from pos to the object-eof, or to the end
+// of the buffer like Amf0Object::read().
+static error_t amf0_properties_extent(const char* p, int64_t size, int64_t pos, int depth, int64_t* psize)
+{
+    error_t err = errorsOK;
+
+    while (pos < size) {
+        if (amf0_view_is_eof(p + pos, size - pos)) {
+            pos += 3;
+            break;
+        }
+
+        // property-name: utf8 string
+        if (size - pos < 2) {
+            return errors_new(-1, "name requires 2 only %" PRId64 " bytes", size - pos);
+        }
+        int len = be_read16(p + pos);
+        pos += 2;
+        if (size - pos < len) {
+            return errors_new(-1, "name requires %d only %" PRId64 " bytes", len, size - pos);
+        }
+        pos += len;
+
+        // property-value: any
+        int64_t n = 0;
+        if ((err = amf0_do_extent(p + pos, size - pos, depth + 1, &n)) != errorsOK) {
+            return errors_wrap(err, "property value");
+        }
+        pos += n;
+    }
+
+    *psize = pos;
+    return err;
+}
+
+static error_t amf0_do_extent(const char* p, int64_t size, int depth, int64_t* psize)
+{
+    error_t err = errorsOK;
+
+    if (depth > AMF0_VIEW_MAX_DEPTH) {
+        return errors_new(-1, "nested over %d", AMF0_VIEW_MAX_DEPTH);
+    }
+
+    // detect the object-eof specially, like Amf0Any::discovery().
+    if (amf0_view_is_eof(p, size)) {
+        *psize = 3;
+        return err;
+    }
+
+    if (size < 1) {
+        return errors_new(-1, "marker requires 1 only %" PRId64 " bytes", size);
+    }
+
+    int64_t need = 0;
+    switch (p[0]) {
+        case RTMP_AMF0_Number:
+            need = 1 + 8;
+            break;
+        case RTMP_AMF0_Boolean:
+            need = 1 + 1;
+            break;
+        case RTMP_AMF0_Null:
+        case RTMP_AMF0_Undefined:
+            need = 1;
+            break;
+        case RTMP_AMF0_Date:
+            need = 1 + 8 + 2;
+            break;
+        case RTMP_AMF0_String:
+            if (size < 3) {
+                return errors_new(-1, "string requires 3 only %" PRId64 " bytes", size);
+            }
+            need = 3 + be_read16(p + 1);
+            break;
+        case RTMP_AMF0_LongString:
+            if (size < 5) {
+                return errors_new(-1, "long string requires 5 only %" PRId64 " bytes", size);
+            }
+            need = 5 + (int64_t)be_read32(p + 1);
+            break;
+        case RTMP_AMF0_Object:
+            return amf0_properties_extent(p, size, 1, depth, psize);
+        case RTMP_AMF0_EcmaArray:
+            if (size < 5) {
+                return errors_new(-1, "EcmaArray requires 5 only %" PRId64 " bytes", size);
+            }
+            return amf0_properties_extent(p, size, 5, depth, psize);
+        case RTMP_AMF0_StrictArray: {
+            if (size < 5) {
+                return errors_new(-1, "StrictArray requires 5 only %" PRId64 " bytes", size);
+            }
+            // the elems to the count, or to the end of the buffer like
+            // Amf0StrictArray::read().
+            int32_t count = (int32_t)be_read32(p + 1);
+            int64_t pos = 5;
+            for (int32_t i = 0; i < count && pos < size; i++) {
+                int64_t n = 0;
+                if ((err = amf0_do_extent(p + pos, size - pos, depth + 1, &n)) != errorsOK) {
+                    return errors_wrap(err, "elem %d", i);
+                }
+                pos += n;
+            }
+            *psize = pos;
+            return err;
+        }
+        default:
+            return errors_new(-1, "invalid amf0 message, marker=%#x", p[0]);
+    }
+
+    if (size < need) {
+        return errors_new(-1, "marker=%#x requires %" PRId64 " only %" PRId64 " bytes", p[0], need, size);
+    }
+    *psize = need;
+    return err;
+}
+
+error_t amf0_extent(const char* p, int64_t size, int64_t* psize)
+{
+    return amf0_do_extent(p, size, 0, psize);
+}
+
+error_t amf0_view_next(StreamBuf* stream, Amf0View* value)
+{
+    error_t err = errorsOK;
+
+    int64_t size = 0;
+    if ((err = amf0_extent(stream->head(), stream->Remain(), &size)) != errorsOK) {
+        return errors_wrap(err, "extent");
+    }
+
+    *value = Amf0View(stream->head(), size);
+    stream->Skip(size);
+    return err;
+}
+
+Amf0View::Amf0View() : data(NULL), size(0)
+{
+}
+
+Amf0View::Amf0View(const char* data, int64_t size) : data(data), size(size)
+{
+}
+
+char Amf0View::marker() const
+{
+    if (size <= 0) {
+        return RTMP_AMF0_Invalid;
+    }
+    if (size == 3 && amf0_view_is_eof(data, size)) {
+        return RTMP_AMF0_ObjectEnd;
+    }
+    return data[0];
+}
+
+std::string_view Amf0View::to_str() const
+{
+    if (marker() == RTMP_AMF0_LongString) {
+        assert(size >= 5);
+        return std::string_view(data + 5, size - 5);
+    }
+    assert(marker() == RTMP_AMF0_String && size >= 3);
+    return std::string_view(data + 3, size - 3);
+}
+
+bool Amf0View::to_boolean() const
+{
+    assert(marker() == RTMP_AMF0_Boolean && size >= 2);
+    return data[1] != 0;
+}
+
+double Amf0View::to_number() const
+{
+    assert(marker() == RTMP_AMF0_Number && size >= 9);
+    uint64_t temp = be_read64(data + 1);
+    double value;
+    memcpy(&value, &temp, 8);
+    return value;
+}
+
+int64_t Amf0View::to_date() const
+{
+    assert(marker() == RTMP_AMF0_Date && size >= 11);
+    return (int64_t)be_read64(data + 1);
+}
+
+int32_t Amf0View::declared_count() const
+{
+    assert((marker() == RTMP_AMF0_EcmaArray || marker() == RTMP_AMF0_StrictArray) && size >= 5);
+    return (int32_t)be_read32(data + 1);
+}
+
+bool Amf0View::get_property(std::string_view name, Amf0View* value) const
+{
+    if (!is_object() && !is_ecma_array()) {
+        return false;
+    }
+
+    // the first property of the name, the values before it are skipped.
+    Amf0ViewIterator it(*this);
+    std::string_view key;
+    while (it.Next(&key, value)) {
+        if (key == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Amf0View::at(int i, Amf0View* value) const
+{
+    if (!is_strict_array() || i < 0) {
+        return false;
+    }
+
+    Amf0ViewIterator it(*this);
+    std::string_view key;
+    for (int j = 0; it.Next(&key, value); j++) {
+        if (j == i) {
+            return true;
+        }
+    }
+    return false;
+}
+
+error_t Amf0View::decode(Amf0Any** ppvalue, Arena* arena) const
+{
+    error_t err = errorsOK;
+
+    if (size <= 0) {
+        return errors_new(-1, "decode empty view");
+    }
+
+    // the decoder only reads the buffer.
+    StreamBuf stream(const_cast<char*>(data), size);
+    if ((err = amf0_read_any(&stream, ppvalue, arena)) != errorsOK) {
+        return errors_wrap(err, "decode");
+    }
+    return err;
+}
+
+Amf0ViewIterator::Amf0ViewIterator(const Amf0View& v)
+{
+    p = end = NULL;
+    left = -1;
+
+    const char* data = v.Data();
+    if (v.is_object()) {
+        p = data + 1;
+    } else if (v.is_ecma_array() && v.Size() >= 5) {
+        p = data + 5;
+    } else if (v.is_strict_array() && v.Size() >= 5) {
+        p = data + 5;
+        left = std::max(v.declared_count(), 0);
+    } else {
+        return;
+    }
+    end = data + v.Size();
+}
+
+bool Amf0ViewIterator::Next(std::string_view* key, Amf0View* value)
+{
+    if (p >= end) {
+        return false;
+    }
+
+    if (left >= 0) {
+        if (left == 0) {
+            return false;
+        }
+        left--;
+        *key = std::string_view();
+    } else {
+        if (amf0_view_is_eof(p, end - p) || end - p < 2) {
+            p = end;
+            return false;
+        }
+        int len = be_read16(p);
+        if (end - p - 2 < len) {
+            p = end;
+            return false;
+        }
+        *key = std::string_view(p + 2, len);
+        p += 2 + len;
+    }
+
+    // the view was walked by amf0_extent(), only a view made by hand fails.
+    int64_t n = 0;
+    error_t err = amf0_extent(p, end - p, &n);
+    if (err != errorsOK) {
+        errors_free(err);
+        p = end;
+        return false;
+    }
+
+    *value = Amf0View(p, n);
+    p += n;
+    return true;
+}
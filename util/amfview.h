@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string_view>
+
+#include "common.h"
+#include "amf.h"
+
+/**
+ * the lazy view of an amf0 value in a raw buffer, e.g. the onMetaData of
+ * a script tag. only the extent of the value is known, nothing is decoded
+ * or allocated until a scalar is accessed or a property is looked up, the
+ * values before it are skipped by their extents.
+ * @remark the buffer must outlive the view.
+ */
+class Amf0View
+{
+private:
+    // the value, from the marker.
+    const char* data;
+    int64_t size;
+public:
+    Amf0View();
+    Amf0View(const char* data, int64_t size);
+public:
+    const char* Data() const { return data; }
+    int64_t Size() const { return size; }
+    bool empty() const { return size <= 0; }
+    /**
+     * the marker, RTMP_AMF0_Invalid if empty. the object-eof, 00 00 09, is
+     * RTMP_AMF0_ObjectEnd.
+     */
+    char marker() const;
+    bool is_string() const { return marker() == RTMP_AMF0_String || marker() == RTMP_AMF0_LongString; }
+    bool is_boolean() const { return marker() == RTMP_AMF0_Boolean; }
+    bool is_number() const { return marker() == RTMP_AMF0_Number; }
+    bool is_null() const { return marker() == RTMP_AMF0_Null; }
+    bool is_undefined() const { return marker() == RTMP_AMF0_Undefined; }
+    bool is_object() const { return marker() == RTMP_AMF0_Object; }
+    bool is_ecma_array() const { return marker() == RTMP_AMF0_EcmaArray; }
+    bool is_strict_array() const { return marker() == RTMP_AMF0_StrictArray; }
+    bool is_date() const { return marker() == RTMP_AMF0_Date; }
+public:
+    /**
+     * decode the scalar in place.
+     * @remark assert the type, like Amf0Any, user must ensure it.
+     */
+    std::string_view to_str() const;
+    bool to_boolean() const;
+    double to_number() const;
+    int64_t to_date() const;
+    /**
+     * the declared count of an ecma array or a strict array.
+     */
+    int32_t declared_count() const;
+    /**
+     * the value of the property name of an object or an ecma array, the
+     * first one if duplicated.
+     * @return false if not found, or not an object.
+     */
+    bool get_property(std::string_view name, Amf0View* value) const;
+    /**
+     * the i-th elem of a strict array.
+     * @return false if out of range, or not a strict array.
+     */
+    bool at(int i, Amf0View* value) const;
+    /**
+     * decode the whole value to an Amf0Any tree, see amf0_read_any().
+     */
+    error_t decode(Amf0Any** ppvalue, Arena* arena = NULL) const;
+};
+
+/**
+ * iterate the properties of an object or an ecma array, or the elems of
+ * a strict array with an empty key, each value is skipped by its extent.
+ */
+class Amf0ViewIterator
+{
+private:
+    const char* p;
+    const char* end;
+    // the elems left of a strict array, -1 for properties.
+    int64_t left;
+public:
+    Amf0ViewIterator(const Amf0View& v);
+public:
+    /**
+     * move to the next property.
+     * @return false at the end.
+     */
+    bool Next(std::string_view* key, Amf0View* value);
+};
+
+/**
+ * the bytes of the amf0 value at p, by a walk over the markers, nested
+ * values are checked but not decoded.
+ * @param psize, output the extent of the value, including the marker.
+ */
+extern error_t amf0_extent(const char* p, int64_t size, int64_t* psize);
+
+/**
+ * the view of the next amf0 value of the stream, then skip it.
+ */
+extern error_t amf0_view_next(StreamBuf* stream, Amf0View* value);
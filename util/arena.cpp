@@ -0,0 +1,57 @@
+#include "arena.h"
+#include <stdlib.h>
+#include <new>
+
+Arena::Arena(size_t block_size)
+{
+    p = end = NULL;
+    this->block_size = block_size;
+}
+
+Arena::~Arena()
+{
+    Reset();
+    if (!blocks.empty()) {
+        free(blocks[0]);
+    }
+}
+
+void Arena::Reset()
+{
+    for (size_t i = 0; i < larges.size(); i++) {
+        free(larges[i]);
+    }
+    larges.clear();
+
+    if (blocks.empty()) {
+        return;
+    }
+    for (size_t i = 1; i < blocks.size(); i++) {
+        free(blocks[i]);
+    }
+    blocks.resize(1);
+    p = blocks[0];
+    end = p + block_size;
+}
+
+void* Arena::grow(size_t size)
+{
+    // a big allocation has its own block, the current one goes on.
+    if (size > block_size / 4) {
+        char* b = (char*)malloc(size);
+        if (!b) {
+            throw std::bad_alloc();
+        }
+        larges.push_back(b);
+        return b;
+    }
+
+    char* b = (char*)malloc(block_size);
+    if (!b) {
+        throw std::bad_alloc();
+    }
+    blocks.push_back(b);
+    p = b + size;
+    end = b + block_size;
+    return b;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * the bump allocator for trees of small objects decoded together, e.g.
+ * the AMF0 values of a script tag.
+ * memory is taken from big blocks and released all at once by Reset(),
+ * so a tree of thousands of nodes costs a few allocations.
+ * @remark no destructor is called, the owner destroys the objects first.
+ */
+class Arena
+{
+private:
+    // the blocks, the first one is kept by Reset() to be reused.
+    std::vector<char*> blocks;
+    // the allocations bigger than a quarter of a block, one each.
+    std::vector<char*> larges;
+    char* p;
+    char* end;
+    size_t block_size;
+private:
+    Arena(const Arena&);
+    Arena& operator=(const Arena&);
+public:
+    Arena(size_t block_size = 64 * 1024);
+    ~Arena();
+public:
+    /**
+     * allocate size bytes aligned to 16 bytes.
+     */
+    inline void* Alloc(size_t size) {
+        size = (size + 15) & ~(size_t)15;
+        if ((size_t)(end - p) < size) {
+            return grow(size);
+        }
+        void* v = p;
+        p += size;
+        return v;
+    }
+    /**
+     * release all allocations at once, keep the first block.
+     */
+    void Reset();
+private:
+    void* grow(size_t size);
+};
@@ -0,0 +1,70 @@
+#include "bitreader.h"
+
+BitReader::BitReader(const char* data, int64_t size, bool emulation_prevention)
+{
+    p = (const uint8_t*)data;
+    end = p + (size > 0 ? size : 0);
+    cache = 0;
+    bits = 0;
+    this->emulation_prevention = emulation_prevention;
+    zeros = 0;
+    overflow = false;
+}
+
+BitReader::BitReader(StreamBuf* stream, bool emulation_prevention)
+    : BitReader(stream->head(), stream->Remain(), emulation_prevention)
+{
+}
+
+void BitReader::refill()
+{
+    // the fast path, whole bytes of one big-endian load.
+    if (!emulation_prevention && end - p >= 8) {
+        int n = (64 - bits) >> 3;
+        uint64_t v = be_read64((const char*)p);
+        cache |= v >> bits;
+        bits += n * 8;
+        // drop the bits of the byte not taken.
+        if (bits < 64) {
+            cache &= ~(((uint64_t)1 << (64 - bits)) - 1);
+        }
+        p += n;
+        return;
+    }
+
+    while (bits <= 56 && p < end) {
+        uint8_t b = *p++;
+        if (emulation_prevention) {
+            // emulation_prevention_three_byte, 7.4.1 of H.264.
+            if (zeros >= 2 && b == 0x03) {
+                zeros = 0;
+                continue;
+            }
+            zeros = (b == 0) ? zeros + 1 : 0;
+        }
+        cache |= (uint64_t)b << (56 - bits);
+        bits += 8;
+    }
+}
+
+uint32_t BitReader::underflow(int n)
+{
+    // the bits left padded by zeros.
+    overflow = true;
+    uint32_t v = (uint32_t)(cache >> (64 - n));
+    cache = 0;
+    bits = 0;
+    return v;
+}
+
+uint32_t BitReader::readLongUE()
+{
+    int lz = 0;
+    while (!ReadBit()) {
+        if (overflow || ++lz > 31) {
+            overflow = true;
+            return 0;
+        }
+    }
+    return ((1u << lz) - 1) + ReadBits(lz);
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include "byteorder.h"
+#include "streambuf.h"
+
+/**
+ * the msb-first bit reader for codec configs, e.g. AudioSpecificConfig
+ * and H.264 SPS, with ue(v)/se(v) Exp-Golomb decoding.
+ * up to 64 bits are cached, refilled 8 bytes at a time in the plain mode.
+ * in the emulation prevention mode, for a NALU payload, the 0x03 of every
+ * 0x000003 is dropped while refilling.
+ * @remark reading past the end returns zero bits and sets Overflow(), so
+ *       a parser checks once after its fields.
+ */
+class BitReader
+{
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+    // the next bits, left aligned, and the number of valid bits.
+    uint64_t cache;
+    int bits;
+    bool emulation_prevention;
+    // the consecutive zero bytes refilled, for emulation prevention.
+    int zeros;
+    bool overflow;
+public:
+    BitReader(const char* data, int64_t size, bool emulation_prevention = false);
+    // over the remaining bytes of the stream, which is not consumed.
+    BitReader(StreamBuf* stream, bool emulation_prevention = false);
+public:
+    /**
+     * read n bits, 0 <= n <= 32.
+     */
+    inline uint32_t ReadBits(int n) {
+        if (n == 0) {
+            return 0;
+        }
+        if (bits < n) {
+            refill();
+            if (bits < n) {
+                return underflow(n);
+            }
+        }
+        uint32_t v = (uint32_t)(cache >> (64 - n));
+        cache <<= n;
+        bits -= n;
+        return v;
+    }
+    inline bool ReadBit() {
+        return ReadBits(1) != 0;
+    }
+    inline void SkipBits(int64_t n) {
+        while (n > 32) {
+            ReadBits(32);
+            n -= 32;
+        }
+        ReadBits((int)n);
+    }
+    /**
+     * unsigned Exp-Golomb, ue(v), at most 32 bits.
+     */
+    inline uint32_t ReadUE() {
+        if (bits < 32) {
+            refill();
+        }
+        // the leading zeros and the prefix one in the cache.
+        if (cache != 0) {
+            int lz = __builtin_clzll(cache);
+            if (lz < 32 && 2 * lz + 1 <= bits) {
+                cache <<= lz + 1;
+                bits -= lz + 1;
+                return ((1u << lz) - 1) + ReadBits(lz);
+            }
+        }
+        return readLongUE();
+    }
+    /**
+     * signed Exp-Golomb, se(v).
+     */
+    inline int32_t ReadSE() {
+        uint32_t k = ReadUE();
+        return (k & 0x01) ? (int32_t)((k + 1) >> 1) : -(int32_t)(k >> 1);
+    }
+    // skip to the next byte boundary.
+    inline void ByteAlign() {
+        ReadBits(bits & 0x07);
+    }
+public:
+    inline bool Overflow() {
+        return overflow;
+    }
+    // whether any bit is left to read.
+    inline bool empty() {
+        return bits == 0 && p >= end;
+    }
+    // the bits left, an upper bound in the emulation prevention mode.
+    inline int64_t BitsLeft() {
+        return bits + (int64_t)(end - p) * 8;
+    }
+private:
+    void refill();
+    uint32_t underflow(int n);
+    uint32_t readLongUE();
+};
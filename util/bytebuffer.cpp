@@ -0,0 +1,34 @@
+#include "bytebuffer.h"
+#include <stdlib.h>
+#include <new>
+
+ByteBuffer::ByteBuffer(int64_t initial)
+{
+    buf = NULL;
+    size = 0;
+    capacity = 0;
+    if (initial > 0) {
+        grow(initial);
+    }
+}
+
+ByteBuffer::~ByteBuffer()
+{
+    free(buf);
+}
+
+void ByteBuffer::grow(int64_t required)
+{
+    // double, at least a small block to avoid tiny reallocations.
+    int64_t n = capacity > 0 ? capacity : 256;
+    while (n < required) {
+        n *= 2;
+    }
+
+    char* p = (char*)realloc(buf, n);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    buf = p;
+    capacity = n;
+}
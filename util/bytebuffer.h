@@ -0,0 +1,108 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include "byteorder.h"
+
+/**
+ * the growable output buffer for muxing.
+ * fields are appended big-endian, the buffer grows geometrically so
+ * appends are amortized O(1), and a size field written before its
+ * content is back-patched at its Mark() once the content is known.
+ * @remark Data() is invalidated when the buffer grows, keep marks.
+ */
+class ByteBuffer
+{
+private:
+    char* buf;
+    int64_t size;
+    int64_t capacity;
+private:
+    ByteBuffer(const ByteBuffer&);
+    ByteBuffer& operator=(const ByteBuffer&);
+public:
+    ByteBuffer(int64_t initial = 0);
+    ~ByteBuffer();
+public:
+    /**
+     * make room for at least n more bytes, so the next appends of n bytes
+     * never grow.
+     */
+    inline void Reserve(int64_t n) {
+        if (size + n > capacity) {
+            grow(size + n);
+        }
+    }
+    /**
+     * append n bytes left to the caller to write, return where they are.
+     */
+    inline char* Extend(int64_t n) {
+        Reserve(n);
+        char* p = buf + size;
+        size += n;
+        return p;
+    }
+    // drop the content, keep the capacity.
+    inline void Clear() {
+        size = 0;
+    }
+    // drop the content after a mark, to roll back a failed write.
+    inline void Truncate(int64_t mark) {
+        assert(mark >= 0 && mark <= size);
+        size = mark;
+    }
+    inline char* Data() {
+        return buf;
+    }
+    inline int64_t Size() {
+        return size;
+    }
+    inline int64_t Capacity() {
+        return capacity;
+    }
+public:
+    inline void Write1Bytes(uint8_t value) {
+        *Extend(1) = (char)value;
+    }
+    inline void Write2Bytes(uint16_t value) {
+        be_write16(Extend(2), value);
+    }
+    inline void Write3Bytes(uint32_t value) {
+        be_write24(Extend(3), value);
+    }
+    inline void Write4Bytes(uint32_t value) {
+        be_write32(Extend(4), value);
+    }
+    inline void Write8Bytes(int64_t value) {
+        be_write64(Extend(8), (uint64_t)value);
+    }
+    inline void WriteBytes(const char* data, int64_t n) {
+        if (n > 0) {
+            memcpy(Extend(n), data, n);
+        }
+    }
+    inline void write_string(const std::string& value) {
+        WriteBytes(value.data(), (int64_t)value.length());
+    }
+public:
+    // the position of the next byte, to patch a field written there.
+    inline int64_t Mark() {
+        return size;
+    }
+    inline void Patch1Bytes(int64_t mark, uint8_t value) {
+        assert(mark >= 0 && mark + 1 <= size);
+        buf[mark] = (char)value;
+    }
+    inline void Patch3Bytes(int64_t mark, uint32_t value) {
+        assert(mark >= 0 && mark + 3 <= size);
+        be_write24(buf + mark, value);
+    }
+    inline void Patch4Bytes(int64_t mark, uint32_t value) {
+        assert(mark >= 0 && mark + 4 <= size);
+        be_write32(buf + mark, value);
+    }
+private:
+    void grow(int64_t required);
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * big-endian readers and writers over unaligned bytes.
+ * each is one unaligned load or store plus a byte swap, and inlines to
+ * a couple of instructions; the portable fallback assembles the bytes.
+ */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && defined(__GNUC__)
+    #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        #define FLV_BSWAP16(v) __builtin_bswap16(v)
+        #define FLV_BSWAP32(v) __builtin_bswap32(v)
+        #define FLV_BSWAP64(v) __builtin_bswap64(v)
+    #else
+        #define FLV_BSWAP16(v) (v)
+        #define FLV_BSWAP32(v) (v)
+        #define FLV_BSWAP64(v) (v)
+    #endif
+#endif
+
+#ifdef FLV_BSWAP16
+
+static inline uint16_t be_read16(const char* p)
+{
+    uint16_t v;
+    memcpy(&v, p, 2);
+    return FLV_BSWAP16(v);
+}
+
+static inline uint32_t be_read32(const char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return FLV_BSWAP32(v);
+}
+
+static inline uint64_t be_read64(const char* p)
+{
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return FLV_BSWAP64(v);
+}
+
+static inline void be_write16(char* p, uint16_t v)
+{
+    v = FLV_BSWAP16(v);
+    memcpy(p, &v, 2);
+}
+
+static inline void be_write32(char* p, uint32_t v)
+{
+    v = FLV_BSWAP32(v);
+    memcpy(p, &v, 4);
+}
+
+static inline void be_write64(char* p, uint64_t v)
+{
+    v = FLV_BSWAP64(v);
+    memcpy(p, &v, 8);
+}
+
+#else
+
+static inline uint16_t be_read16(const char* p)
+{
+    const uint8_t* u = (const uint8_t*)p;
+    return (uint16_t)((u[0] << 8) | u[1]);
+}
+
+static inline uint32_t be_read32(const char* p)
+{
+    const uint8_t* u = (const uint8_t*)p;
+    return ((uint32_t)u[0] << 24) | ((uint32_t)u[1] << 16) | ((uint32_t)u[2] << 8) | u[3];
+}
+
+static inline uint64_t be_read64(const char* p)
+{
+    return ((uint64_t)be_read32(p) << 32) | be_read32(p + 4);
+}
+
+static inline void be_write16(char* p, uint16_t v)
+{
+    p[0] = (char)(v >> 8);
+    p[1] = (char)v;
+}
+
+static inline void be_write32(char* p, uint32_t v)
+{
+    p[0] = (char)(v >> 24);
+    p[1] = (char)(v >> 16);
+    p[2] = (char)(v >> 8);
+    p[3] = (char)v;
+}
+
+static inline void be_write64(char* p, uint64_t v)
+{
+    be_write32(p, (uint32_t)(v >> 32));
+    be_write32(p + 4, (uint32_t)v);
+}
+
+#endif
+
+// 24bits fields, the DataSize and Timestamp of flv tags, SI24 cts.
+static inline uint32_t be_read24(const char* p)
+{
+    return ((uint32_t)be_read16(p) << 8) | (uint8_t)p[2];
+}
+
+static inline void be_write24(char* p, uint32_t v)
+{
+    be_write16(p, (uint16_t)(v >> 8));
+    p[2] = (char)v;
+}
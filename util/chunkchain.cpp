@@ -0,0 +1,58 @@
+#include "chunkchain.h"
+
+ChunkSource::ChunkSource()
+{
+    pos = 0;
+    remain = 0;
+    offset = 0;
+}
+
+ChunkSource::~ChunkSource()
+{
+}
+
+void ChunkSource::Append(const char* data, int64_t size)
+{
+    if (size <= 0) {
+        return;
+    }
+    ChunkView c;
+    c.data = data;
+    c.size = size;
+    chunks.push_back(c);
+    remain += size;
+}
+
+int ChunkSource::ReadSlices(int64_t size, std::vector<ChunkView>* pieces)
+{
+    assert(size >= 0 && size <= remain);
+    pieces->clear();
+
+    int64_t p = pos;
+    int64_t left = size;
+    for (size_t i = 0; i < chunks.size() && left > 0; i++) {
+        ChunkView v;
+        v.data = chunks[i].data + p;
+        v.size = chunks[i].size - p < left ? chunks[i].size - p : left;
+        pieces->push_back(v);
+        left -= v.size;
+        p = 0;
+    }
+
+    Advance(size);
+    return (int)pieces->size();
+}
+
+const char* ChunkSource::gather(int64_t n, char* scratch)
+{
+    assert(n <= remain);
+    int64_t p = pos;
+    int64_t copied = 0;
+    for (size_t i = 0; copied < n; i++) {
+        int64_t k = chunks[i].size - p < n - copied ? chunks[i].size - p : n - copied;
+        memcpy(scratch + copied, chunks[i].data + p, k);
+        copied += k;
+        p = 0;
+    }
+    return scratch;
+}
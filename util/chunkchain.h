@@ -0,0 +1,80 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+#include "streamreader.h"
+
+/**
+ * a non-owning piece of bytes, like iovec.
+ */
+typedef struct ChunkView {
+    const char* data;
+    int64_t size;
+} ChunkView;
+
+/**
+ * the source of a chain of chunks, as received from a socket, so they
+ * are read without being concatenated first.
+ * a read across chunks is gathered to the scratch of Peek(), a slice is
+ * a view in place, or the list of pieces when it spans chunks.
+ * @remark the chunks are not owned, a chunk is no longer referenced once
+ *       Offset() passes its end. only forward Skip() is supported.
+ */
+class ChunkSource
+{
+private:
+    std::deque<ChunkView> chunks;
+    // the read position in the front chunk.
+    int64_t pos;
+    // the bytes left in all chunks, and consumed from the start.
+    int64_t remain;
+    int64_t offset;
+public:
+    ChunkSource();
+    ~ChunkSource();
+public:
+    // append a chunk to the tail, empty ones are ignored.
+    void Append(const char* data, int64_t size);
+public:
+    inline int64_t Remain() {
+        return remain;
+    }
+    inline int64_t Offset() {
+        return offset;
+    }
+    inline const char* Peek(int64_t n, char* scratch) {
+        const ChunkView& c = chunks.front();
+        if (pos + n <= c.size) {
+            return c.data + pos;
+        }
+        return gather(n, scratch);
+    }
+    inline void Advance(int64_t n) {
+        assert(n >= 0 && n <= remain);
+        remain -= n;
+        offset += n;
+        n += pos;
+        while (!chunks.empty() && n >= chunks.front().size) {
+            n -= chunks.front().size;
+            chunks.pop_front();
+        }
+        pos = n;
+    }
+    // the bytes readable in place in the front chunk.
+    inline int64_t ContiguousRemain() {
+        return chunks.empty() ? 0 : chunks.front().size - pos;
+    }
+    /**
+     * consume the next size bytes as views in place, a single piece
+     * when they are in one chunk, else one piece per chunk spanned.
+     * @return the number of pieces.
+     */
+    int ReadSlices(int64_t size, std::vector<ChunkView>* pieces);
+private:
+    const char* gather(int64_t n, char* scratch);
+};
+
+typedef StreamReader<ChunkSource> ChunkReader;
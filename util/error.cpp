@@ -1,23 +1,82 @@
 #include "error.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
 
 errors::errors(/* args */)
 {
     // illegal direct call.
+    code = 0;
+    func = NULL;
+    file = NULL;
+    line = 0;
+    wrapped = NULL;
 }
 
 errors::~errors()
 {
+    delete wrapped;
+}
 
+static string format_message(const char* fmt, va_list ap)
+{
+    char buf[1024];
+    vsnprintf(buf, sizeof(buf), fmt, ap);
+    return buf;
 }
 
 errors* errors::creat(const char* func, const char* file, int line, int code, const char* fmt, ...) {
-    return nullptr;
+    errors* err = new errors();
+    err->code = code;
+    err->func = func;
+    err->file = file;
+    err->line = line;
+
+    va_list ap;
+    va_start(ap, fmt);
+    err->msg = format_message(fmt, ap);
+    va_end(ap);
+
+    return err;
 }
 
 errors* errors::wrap(const char* func, const char* file, int line, errors* ret, const char* fmt, ...) {
-    return nullptr;
+    if (!ret) {
+        return NULL;
+    }
+
+    errors* err = new errors();
+    err->code = ret->code;
+    err->func = func;
+    err->file = file;
+    err->line = line;
+    err->wrapped = ret;
+
+    va_list ap;
+    va_start(ap, fmt);
+    err->msg = format_message(fmt, ap);
+    va_end(ap);
+
+    return err;
 }
 
 string errors::description(errors* ret) {
-    return "";
-}
\ No newline at end of file
+    if (!ret) {
+        return "success";
+    }
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "code=%d", ret->code);
+    string desc = buf;
+    for (errors* err = ret; err; err = err->wrapped) {
+        const char* name = strrchr(err->file, '/');
+        name = name ? name + 1 : err->file;
+        snprintf(buf, sizeof(buf), ":%d", err->line);
+        desc += string(" : ") + err->msg + " at " + err->func + "() [" + name + buf + "]";
+    }
+    return desc;
+}
+
+int errors::error_code(errors* err) {
+    return err ? err->code : 0;
+}
@@ -7,16 +7,34 @@ class errors;
 #define errors_new(ret, fmt, ...) errors::creat(__FUNCTION__, __FILE__, __LINE__, ret, fmt, ##__VA_ARGS__)
 #define errors_wrap(ret, fmt, ...) errors::wrap(__FUNCTION__, __FILE__, __LINE__, ret, fmt, ##__VA_ARGS__)
 #define errors_description(ret, fmt, ...) errors::description(__FUNCTION__, __FILE__, __LINE__, ret, fmt, ##__VA_ARGS__)
+// free the error and reset it to errorsOK.
+#define errors_free(ret) do { delete (ret); (ret) = errorsOK; } while (0)
 #define errorsOK  0
 typedef errors* error_t;
 
+// the input ends before the bytes a field requires.
+#define ERROR_STREAM_EOF -2
+
+/**
+ * the error owned by the caller which receives it, errors_wrap() takes
+ * the ownership of the wrapped one, errors_free() frees the whole chain.
+ */
 class errors {
 private:
     /* data */
+    int code;
+    string msg;
+    const char* func;
+    const char* file;
+    int line;
+    errors* wrapped;
+private:
     errors(/* args */);
 public:
     ~errors();
     static errors *creat(const char* func, const char* file, int line, int code, const char* fmt, ...);
     static errors *wrap(const char* func, const char* file, int line, errors* ret, const char* fmt, ...);
     static string description(errors* err);
+    // the code of the innermost error, errorsOK for none.
+    static int error_code(errors* err);
 };
@@ -0,0 +1,113 @@
+#include "mmapfile.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <inttypes.h>
+
+MmapFile::MmapFile()
+{
+    fd = -1;
+    data = NULL;
+    size = 0;
+}
+
+MmapFile::~MmapFile()
+{
+    Close();
+}
+
+error_t MmapFile::Open(const char* path, bool populate)
+{
+    error_t err = errorsOK;
+
+    Close();
+
+    if ((fd = ::open(path, O_RDONLY)) < 0) {
+        return errors_new(-1, "open %s failed", path);
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        Close();
+        return errors_new(-1, "stat %s failed", path);
+    }
+    size = (int64_t)st.st_size;
+
+    // nothing to map for an empty file.
+    if (size == 0) {
+        return err;
+    }
+
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (populate) {
+        flags |= MAP_POPULATE;
+    }
+#else
+    (void)populate;
+#endif
+
+    void* p = mmap(NULL, (size_t)size, PROT_READ, flags, fd, 0);
+    if (p == MAP_FAILED) {
+        Close();
+        return errors_new(-1, "mmap %s failed, size=%" PRId64, path, size);
+    }
+    data = (char*)p;
+
+    return err;
+}
+
+void MmapFile::Close()
+{
+    if (data) {
+        munmap(data, (size_t)size);
+        data = NULL;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    size = 0;
+}
+
+error_t MmapFile::Advise(int advice)
+{
+    return Advise(0, size, advice);
+}
+
+error_t MmapFile::Advise(int64_t offset, int64_t len, int advice)
+{
+    error_t err = errorsOK;
+
+    if (!data || len <= 0) {
+        return err;
+    }
+    if (offset < 0 || offset >= size) {
+        return errors_new(-1, "advise offset %" PRId64 " out of range [0, %" PRId64 ")", offset, size);
+    }
+
+    // madvise requires a page aligned address.
+    int64_t page = sysconf(_SC_PAGESIZE);
+    int64_t start = offset & ~(page - 1);
+    if (offset + len > size) {
+        len = size - offset;
+    }
+
+    if (madvise(data + start, (size_t)(offset + len - start), advice) < 0) {
+        return errors_new(-1, "madvise %d failed, offset=%" PRId64, advice, offset);
+    }
+
+    return err;
+}
+
+char* MmapFile::Data()
+{
+    return data;
+}
+
+int64_t MmapFile::Size()
+{
+    return size;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+#include "error.h"
+
+/**
+ * read-only memory mapping of a whole file.
+ * the bytes are not copied, pages are faulted in by the kernel when
+ * the parser touches them, so opening a huge file costs nothing.
+ * @remark the mapping is PROT_READ, never write through Data().
+ */
+class MmapFile
+{
+private:
+    int fd;
+    char* data;
+    int64_t size;
+private:
+    // owns the mapping, a copy would unmap it twice.
+    MmapFile(const MmapFile&);
+    MmapFile& operator=(const MmapFile&);
+public:
+    MmapFile();
+    ~MmapFile();
+public:
+    /**
+     * open and map the file.
+     * @param populate, prefault all pages when mapping(MAP_POPULATE),
+     *       ignored on platforms without it.
+     */
+    error_t Open(const char* path, bool populate = false);
+    /**
+     * unmap and close the file, safe to call more than once.
+     */
+    void Close();
+    /**
+     * madvise hint for the whole mapping, for example
+     * MADV_SEQUENTIAL for a linear parse or MADV_RANDOM for seeking.
+     */
+    error_t Advise(int advice);
+    /**
+     * madvise hint for [offset, offset+len) of the mapping,
+     * the range is aligned to pages internally and clamped to the end.
+     * @remark an error when offset is out of [0, Size()).
+     */
+    error_t Advise(int64_t offset, int64_t len, int advice);
+public:
+    char* Data();
+    int64_t Size();
+};
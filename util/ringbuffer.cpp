@@ -0,0 +1,49 @@
+#include "ringbuffer.h"
+
+RingSource::RingSource(int64_t size)
+{
+    assert(size > 0);
+    capacity = 1;
+    while ((int64_t)capacity < size) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+    buf = new char[capacity];
+    rpos = wpos = 0;
+}
+
+RingSource::~RingSource()
+{
+    delete[] buf;
+}
+
+int64_t RingSource::Write(const char* data, int64_t size)
+{
+    int64_t written = 0;
+    while (written < size) {
+        int64_t n = 0;
+        char* p = WriteHead(&n);
+        if (n == 0) {
+            break;
+        }
+        n = n < size - written ? n : size - written;
+        memcpy(p, data + written, n);
+        Commit(n);
+        written += n;
+    }
+    return written;
+}
+
+char* RingSource::WriteHead(int64_t* pn)
+{
+    uint64_t w = wpos & mask;
+    int64_t n = (int64_t)(capacity - w);
+    *pn = n < Space() ? n : Space();
+    return buf + w;
+}
+
+void RingSource::Commit(int64_t n)
+{
+    assert(n >= 0 && n <= Space());
+    wpos += n;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include "streamreader.h"
+
+/**
+ * the source of a fixed capacity ring, for continuous live ingest.
+ * the capacity is a power of two and never grows, the producer writes
+ * at the tail and the reader consumes from the head, no byte is moved.
+ * a read across the wrap point is gathered to the scratch of Peek().
+ * @remark the positions are monotonic stream offsets, single thread only.
+ */
+class RingSource
+{
+private:
+    char* buf;
+    uint64_t capacity;
+    uint64_t mask;
+    // the read and write positions, from the start of the stream.
+    uint64_t rpos;
+    uint64_t wpos;
+private:
+    RingSource(const RingSource&);
+    RingSource& operator=(const RingSource&);
+public:
+    // the capacity is rounded up to a power of two.
+    RingSource(int64_t size);
+    ~RingSource();
+public:
+    inline int64_t Remain() {
+        return (int64_t)(wpos - rpos);
+    }
+    inline int64_t Offset() {
+        return (int64_t)rpos;
+    }
+    inline const char* Peek(int64_t n, char* scratch) {
+        uint64_t r = rpos & mask;
+        if (r + n <= capacity) {
+            return buf + r;
+        }
+        int64_t first = (int64_t)(capacity - r);
+        memcpy(scratch, buf + r, first);
+        memcpy(scratch + first, buf, n - first);
+        return scratch;
+    }
+    inline void Advance(int64_t n) {
+        assert(n >= 0 && n <= Remain());
+        rpos += n;
+    }
+    // the bytes readable in place before the wrap point.
+    inline int64_t ContiguousRemain() {
+        int64_t n = (int64_t)(capacity - (rpos & mask));
+        return n < Remain() ? n : Remain();
+    }
+public:
+    inline int64_t Capacity() {
+        return (int64_t)capacity;
+    }
+    inline int64_t Space() {
+        return (int64_t)capacity - Remain();
+    }
+    /**
+     * copy at most Space() bytes of data to the tail.
+     * @return the bytes written.
+     */
+    int64_t Write(const char* data, int64_t size);
+    /**
+     * the free bytes at the tail before the wrap point, to receive into
+     * in place, then Commit() the received bytes.
+     */
+    char* WriteHead(int64_t* pn);
+    void Commit(int64_t n);
+};
+
+typedef StreamReader<RingSource> RingReader;
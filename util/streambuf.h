@@ -1,39 +1,47 @@
 #pragma once
 #include <assert.h>
+#include <stdint.h>
 #include <string>
+#include "streamreader.h"
 
 using namespace std;
 
-class StreamBuf
+/**
+ * the adapter of ContiguousReader for the existing callers, the AMF0 codec
+ * takes a StreamBuf*.
+ * @remark no virtual method: nothing derives from StreamBuf, the ring and
+ *       chunk readers are StreamReader<Source> instances, so a vtable only
+ *       kept the calls through a StreamBuf* from being inlined. hot paths
+ *       may also take reader() directly.
+ */
+class StreamBuf final
 {
 private:
-    /* data */
-    char *p;
-    char *begin;
-    char *end;
-    
-private:
-    StreamBuf();
+    ContiguousReader r;
 public:
-    StreamBuf(char* buf, int len);
+    StreamBuf(char* buf, int64_t len);
     ~StreamBuf();
 public:
-    virtual int Remain();
-    virtual char Read1Byte();
-    virtual uint32_t Read3Bytes();
-    virtual uint32_t Read4Bytes();
-    virtual char *ReadSlice(int size);
-    virtual void Skip(int size);
-    virtual int Offset();
-    virtual uint16_t Read2Bytes();
-    virtual bool require(int size);
-    void Write1Bytes(uint8_t value);
-    // virtual void Write1Bytes(uint8_t value);
-    virtual void Write2Bytes(uint16_t value);
-    virtual void Write4Bytes(uint32_t value);
-    virtual bool empty();
-    int64_t Read8Bytes();
-    void Write8Bytes(int64_t value);
-    string read_string(int len);
-    void write_string(string value);
+    inline ContiguousReader* reader() { return &r; }
+public:
+    inline int64_t Remain() { return r.Remain(); }
+    inline char Read1Byte() { return r.Read1Byte(); }
+    inline uint32_t Read3Bytes() { return r.Read3Bytes(); }
+    inline uint32_t Read4Bytes() { return r.Read4Bytes(); }
+    inline char *ReadSlice(int64_t size) { return r.ReadSlice(size); }
+    inline void Skip(int64_t size) { r.Skip(size); }
+    inline int64_t Offset() { return r.Offset(); }
+    // the current position, to read fields in place.
+    inline char* head() { return r.head(); }
+    inline uint16_t Read2Bytes() { return r.Read2Bytes(); }
+    inline bool require(int64_t size) { return r.require(size); }
+    inline void Write1Bytes(uint8_t value) { r.Write1Bytes(value); }
+    inline void Write2Bytes(uint16_t value) { r.Write2Bytes(value); }
+    inline void Write4Bytes(uint32_t value) { r.Write4Bytes(value); }
+    inline bool empty() { return r.empty(); }
+    inline bool Overflowed() { return r.Overflowed(); }
+    inline int64_t Read8Bytes() { return r.Read8Bytes(); }
+    inline void Write8Bytes(int64_t value) { r.Write8Bytes(value); }
+    inline string read_string(int len) { return r.read_string(len); }
+    inline void write_string(string value) { r.write_string(value); }
 };
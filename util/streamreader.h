@@ -0,0 +1,279 @@
+#pragma once
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include "byteorder.h"
+
+/**
+ * the cursor over bytes already checked by one StreamReader::Take(),
+ * for the fields of a tag, no read is checked again.
+ */
+class UncheckedCursor
+{
+private:
+    const char* p;
+    const char* end;
+public:
+    UncheckedCursor() : p(NULL), end(NULL) {}
+    UncheckedCursor(const char* buf, int64_t len) : p(buf), end(buf + len) {}
+public:
+    inline int64_t Remain() const {
+        return end - p;
+    }
+    inline char Read1Byte() {
+        return *p++;
+    }
+    inline uint16_t Read2Bytes() {
+        uint16_t v = be_read16(p);
+        p += 2;
+        return v;
+    }
+    inline uint32_t Read3Bytes() {
+        uint32_t v = be_read24(p);
+        p += 3;
+        return v;
+    }
+    inline uint32_t Read4Bytes() {
+        uint32_t v = be_read32(p);
+        p += 4;
+        return v;
+    }
+    inline const char* ReadSlice(int64_t size) {
+        const char* t = p;
+        p += size;
+        return t;
+    }
+};
+
+/**
+ * the reader over a source of bytes, the source is a compile-time policy
+ * so every accessor is resolved statically and inlined in the hot loops.
+ * a source provides:
+ *      int64_t Remain();
+ *      int64_t Offset();
+ *      // n contiguous bytes at the position, in place when possible,
+ *      // else copied to scratch which has at least n bytes.
+ *      const char* Peek(int64_t n, char* scratch);
+ *      void Advance(int64_t n);
+ * a contiguous source also provides head(), for slices and writes.
+ * @remark check require() before reading, a read, write or skip past the
+ *       end is never done: the reader is moved to the end, reads return 0
+ *       and Overflowed() reports it, whether NDEBUG is defined or not.
+ */
+template <typename Source>
+class StreamReader : public Source
+{
+private:
+    // whether a read, write or skip went past the end.
+    bool overflowed = false;
+public:
+    using Source::Source;
+public:
+    inline bool require(int64_t size) {
+        return this->Remain() >= size;
+    }
+    inline bool empty() {
+        return this->Remain() <= 0;
+    }
+    inline bool Overflowed() {
+        return overflowed;
+    }
+private:
+    // whether size bytes are left, else move to the end and mark it.
+    inline bool check(int64_t size) {
+        if (size >= 0 && require(size)) {
+            return true;
+        }
+        overflowed = true;
+        this->Advance(this->Remain());
+        return false;
+    }
+public:
+    inline char Read1Byte() {
+        if (!check(1)) {
+            return 0;
+        }
+        char scratch[1];
+        char v = *this->Peek(1, scratch);
+        this->Advance(1);
+        return v;
+    }
+    inline uint16_t Read2Bytes() {
+        if (!check(2)) {
+            return 0;
+        }
+        char scratch[2];
+        uint16_t v = be_read16(this->Peek(2, scratch));
+        this->Advance(2);
+        return v;
+    }
+    inline uint32_t Read3Bytes() {
+        if (!check(3)) {
+            return 0;
+        }
+        char scratch[3];
+        uint32_t v = be_read24(this->Peek(3, scratch));
+        this->Advance(3);
+        return v;
+    }
+    inline uint32_t Read4Bytes() {
+        if (!check(4)) {
+            return 0;
+        }
+        char scratch[4];
+        uint32_t v = be_read32(this->Peek(4, scratch));
+        this->Advance(4);
+        return v;
+    }
+    inline int64_t Read8Bytes() {
+        if (!check(8)) {
+            return 0;
+        }
+        char scratch[8];
+        int64_t v = (int64_t)be_read64(this->Peek(8, scratch));
+        this->Advance(8);
+        return v;
+    }
+    // a negative size moves back, contiguous sources only.
+    inline void Skip(int64_t size) {
+        if (size > this->Remain()) {
+            overflowed = true;
+            size = this->Remain();
+        } else if (size < -this->Offset()) {
+            overflowed = true;
+            size = -this->Offset();
+        }
+        this->Advance(size);
+    }
+    std::string read_string(int len) {
+        if (!check(len)) {
+            return std::string();
+        }
+        std::string value;
+        value.resize(len);
+        Read(&value[0], len);
+        return value;
+    }
+    // copy the next size bytes to dst.
+    inline void Read(char* dst, int64_t size) {
+        if (!check(size)) {
+            memset(dst, 0, size > 0 ? size : 0);
+            return;
+        }
+        while (size > 0) {
+            int64_t n = size < 64 ? size : 64;
+            char scratch[64];
+            memcpy(dst, this->Peek(n, scratch), n);
+            this->Advance(n);
+            dst += n;
+            size -= n;
+        }
+    }
+public:
+    // contiguous sources only, NULL past the end.
+    inline char* ReadSlice(int64_t size) {
+        if (!check(size)) {
+            return NULL;
+        }
+        char* t = this->head();
+        this->Advance(size);
+        return t;
+    }
+    inline void Write1Bytes(uint8_t value) {
+        if (!check(1)) {
+            return;
+        }
+        *this->head() = (char)value;
+        this->Advance(1);
+    }
+    inline void Write2Bytes(uint16_t value) {
+        if (!check(2)) {
+            return;
+        }
+        be_write16(this->head(), value);
+        this->Advance(2);
+    }
+    inline void Write3Bytes(uint32_t value) {
+        if (!check(3)) {
+            return;
+        }
+        be_write24(this->head(), value);
+        this->Advance(3);
+    }
+    inline void Write4Bytes(uint32_t value) {
+        if (!check(4)) {
+            return;
+        }
+        be_write32(this->head(), value);
+        this->Advance(4);
+    }
+    inline void Write8Bytes(int64_t value) {
+        if (!check(8)) {
+            return;
+        }
+        be_write64(this->head(), (uint64_t)value);
+        this->Advance(8);
+    }
+    /**
+     * check once that size bytes are left and consume them, reads of the
+     * cursor over them need no further checks.
+     * @return false and consume nothing when the input is too short.
+     */
+    inline bool Take(int64_t size, UncheckedCursor* pc) {
+        if (size < 0 || !require(size)) {
+            return false;
+        }
+        *pc = UncheckedCursor(this->head(), size);
+        this->Advance(size);
+        return true;
+    }
+    void write_string(const std::string& value) {
+        if (!check((int64_t)value.length())) {
+            return;
+        }
+        memcpy(this->head(), value.data(), value.length());
+        this->Advance((int64_t)value.length());
+    }
+};
+
+/**
+ * the source of a plain buffer [begin, end).
+ */
+class ContiguousSource
+{
+private:
+    char* p;
+    char* begin;
+    char* end;
+public:
+    ContiguousSource(char* buf, int64_t len) {
+        begin = p = buf;
+        end = buf + len;
+    }
+public:
+    inline int64_t Remain() {
+        return end - p;
+    }
+    inline int64_t Offset() {
+        return p - begin;
+    }
+    inline const char* Peek(int64_t /*n*/, char* /*scratch*/) {
+        return p;
+    }
+    // clamped to the buffer, StreamReader reports the overflow.
+    inline void Advance(int64_t n) {
+        if (n > end - p) {
+            n = end - p;
+        } else if (n < begin - p) {
+            n = begin - p;
+        }
+        p += n;
+    }
+    inline char* head() {
+        return p;
+    }
+};
+
+typedef StreamReader<ContiguousSource> ContiguousReader;